@@ -8,6 +8,7 @@
 
 #ifndef _COMMON_HPP_
 #define _COMMON_HPP_
+#include <algorithm>
 #include <chrono>
 #include <iostream>
 #include <string>
@@ -15,7 +16,7 @@
 
 template <typename T = std::chrono::nanoseconds::period> class Timer {
 public:
-  Timer() { overhead(); }
+  Timer() { time_overhead = overhead(); }
   inline void start() {
     time_start = std::chrono::high_resolution_clock::now();
   }
@@ -39,11 +40,28 @@ private:
   std::chrono::high_resolution_clock::time_point time_start, time_end;
   long double time_overhead;
 
-  inline void overhead() {
-    start();
-    end();
-    auto period = std::chrono::duration<long double, T>(time_end - time_start);
-    time_overhead = period.count();
+  /*
+   * Median cost of a back to back start() and end(), calibrated once per
+   * process over many samples so that a single preempted or cold sample
+   * does not skew every measurement.
+   */
+  static long double overhead() {
+    static const long double median = [] {
+      const int samples_count = 1001;
+      std::vector<long double> samples(samples_count);
+
+      for (int i = 0; i < samples_count; i++) {
+        auto sample_start = std::chrono::high_resolution_clock::now();
+        auto sample_end = std::chrono::high_resolution_clock::now();
+        samples[i] =
+            std::chrono::duration<long double, T>(sample_end - sample_start)
+                .count();
+      }
+      std::nth_element(samples.begin(), samples.begin() + samples_count / 2,
+                       samples.end());
+      return samples[samples_count / 2];
+    }();
+    return median;
   }
 };
 
@@ -28,6 +28,9 @@ public:
                    size_t size, void **ptr);
   void memoryAllocHost(size_t size, void **ptr);
   void memoryAllocHost(ze_context_handle_t context, size_t size, void **ptr);
+  void memoryAllocShared(size_t size, void **ptr);
+  void memoryAllocShared(ze_context_handle_t context, ze_device_handle_t device,
+                         size_t size, void **ptr);
   void memoryFree(const void *ptr);
   void memoryFree(ze_context_handle_t context, const void *ptr);
   void functionCreate(ze_kernel_handle_t *function, const char *pFunctionName);
@@ -45,6 +48,12 @@ public:
   void commandListCreate(ze_command_list_handle_t *phCommandList);
   void commandListCreate(ze_device_handle_t device,
                          ze_command_list_handle_t *phCommandList);
+  void commandListCreate(ze_device_handle_t device,
+                         uint32_t command_queue_group_ordinal,
+                         ze_command_list_handle_t *phCommandList);
+  void commandListCreateImmediate(ze_device_handle_t device,
+                                  ze_command_queue_mode_t mode,
+                                  ze_command_list_handle_t *phCommandList);
   void commandListDestroy(ze_command_list_handle_t phCommandList);
   void commandListClose(ze_command_list_handle_t phCommandList);
   void commandListReset(ze_command_list_handle_t phCommandList);
@@ -56,6 +65,9 @@ public:
       uint8_t *srcBuffer, ze_image_region_t *Region, ze_event_handle_t hEvent);
   void commandListAppendMemoryCopy(ze_command_list_handle_t command_list,
                                    void *dstptr, void *srcptr, size_t size);
+  void commandListAppendMemoryCopy(ze_command_list_handle_t command_list,
+                                   void *dstptr, void *srcptr, size_t size,
+                                   ze_event_handle_t hSignalEvent);
   void commandListAppendBarrier(ze_command_list_handle_t command_list);
 
   void commandListAppendImageCopyToMemory(ze_command_list_handle_t command_list,
@@ -78,12 +90,20 @@ public:
   void hostEventSignal(ze_event_handle_t hEvent);
   void hostSynchronize(ze_event_handle_t hEvent, uint32_t timeout);
   void hostSynchronize(ze_event_handle_t hEvent);
+  bool hostEventQuery(ze_event_handle_t hEvent);
+  void hostEventReset(ze_event_handle_t hEvent);
 
   void commandQueueCreate(const uint32_t command_queue_id,
                           ze_command_queue_handle_t *command_queue);
   void commandQueueCreate(ze_device_handle_t device,
                           const uint32_t command_queue_id,
                           ze_command_queue_handle_t *command_queue);
+  void commandQueueCreate(ze_device_handle_t device,
+                          const uint32_t command_queue_group_ordinal,
+                          const uint32_t command_queue_index,
+                          ze_command_queue_handle_t *command_queue);
+  std::vector<ze_command_queue_group_properties_t>
+  commandQueueGroupProperties(ze_device_handle_t device);
   void commandQueueDestroy(ze_command_queue_handle_t command_queue);
   void commandQueueExecuteCommandList(ze_command_queue_handle_t command_queue,
                                       uint32_t numCommandLists,
@@ -118,6 +118,30 @@ void ZeApp::memoryAllocHost(ze_context_handle_t context, size_t size,
   SUCCESS_OR_TERMINATE(zeMemAllocHost(context, &host_desc, size, 1, ptr));
 }
 
+void ZeApp::memoryAllocShared(size_t size, void **ptr) {
+  assert(this->device != nullptr);
+  assert(this->driver != nullptr);
+  assert(this->context != nullptr);
+  memoryAllocShared(this->context, this->device, size, ptr);
+}
+
+void ZeApp::memoryAllocShared(ze_context_handle_t context,
+                              ze_device_handle_t device, size_t size,
+                              void **ptr) {
+  ze_device_mem_alloc_desc_t device_desc = {};
+  device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+  device_desc.pNext = nullptr;
+  device_desc.ordinal = 0;
+  device_desc.flags = 0;
+
+  ze_host_mem_alloc_desc_t host_desc = {};
+  host_desc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+  host_desc.pNext = nullptr;
+  host_desc.flags = 0;
+  SUCCESS_OR_TERMINATE(zeMemAllocShared(context, &device_desc, &host_desc,
+                                        size, 1, device, ptr));
+}
+
 void ZeApp::memoryFree(const void *ptr) {
   assert(this->driver != nullptr);
   SUCCESS_OR_TERMINATE(zeMemFree(this->context, const_cast<void *>(ptr)));
@@ -209,6 +233,32 @@ void ZeApp::commandListCreate(ze_device_handle_t device,
       this->context, device, &command_list_description, phCommandList));
 }
 
+void ZeApp::commandListCreate(ze_device_handle_t device,
+                              uint32_t command_queue_group_ordinal,
+                              ze_command_list_handle_t *phCommandList) {
+  ze_command_list_desc_t command_list_description{};
+  command_list_description.stype = ZE_STRUCTURE_TYPE_COMMAND_LIST_DESC;
+  command_list_description.pNext = nullptr;
+  command_list_description.commandQueueGroupOrdinal =
+      command_queue_group_ordinal;
+
+  SUCCESS_OR_TERMINATE(zeCommandListCreate(
+      this->context, device, &command_list_description, phCommandList));
+}
+
+void ZeApp::commandListCreateImmediate(
+    ze_device_handle_t device, ze_command_queue_mode_t mode,
+    ze_command_list_handle_t *phCommandList) {
+  ze_command_queue_desc_t command_queue_description{};
+  command_queue_description.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+  command_queue_description.pNext = nullptr;
+  command_queue_description.ordinal = 0;
+  command_queue_description.mode = mode;
+
+  SUCCESS_OR_TERMINATE(zeCommandListCreateImmediate(
+      this->context, device, &command_queue_description, phCommandList));
+}
+
 void ZeApp::commandListDestroy(ze_command_list_handle_t command_list) {
   SUCCESS_OR_TERMINATE(zeCommandListDestroy(command_list));
 }
@@ -262,6 +312,14 @@ void ZeApp::commandListAppendMemoryCopy(ze_command_list_handle_t command_list,
       command_list, dstptr, srcptr, size, nullptr, 0, nullptr));
 }
 
+void ZeApp::commandListAppendMemoryCopy(ze_command_list_handle_t command_list,
+                                        void *dstptr, void *srcptr,
+                                        size_t size,
+                                        ze_event_handle_t hSignalEvent) {
+  SUCCESS_OR_TERMINATE(zeCommandListAppendMemoryCopy(
+      command_list, dstptr, srcptr, size, hSignalEvent, 0, nullptr));
+}
+
 void ZeApp::commandListAppendWaitOnEvents(ze_command_list_handle_t CommandList,
                                           uint32_t numEvents,
                                           ze_event_handle_t *phEvents) {
@@ -294,6 +352,19 @@ void ZeApp::hostSynchronize(ze_event_handle_t hEvent) {
   SUCCESS_OR_TERMINATE(zeEventHostSynchronize(hEvent, ~0));
 }
 
+bool ZeApp::hostEventQuery(ze_event_handle_t hEvent) {
+  ze_result_t result = zeEventQueryStatus(hEvent);
+  if (result == ZE_RESULT_NOT_READY)
+    return false;
+  SUCCESS_OR_TERMINATE(result);
+  return true;
+}
+
+void ZeApp::hostEventReset(ze_event_handle_t hEvent) {
+
+  SUCCESS_OR_TERMINATE(zeEventHostReset(hEvent));
+}
+
 void ZeApp::commandQueueCreate(const uint32_t command_queue_id,
                                ze_command_queue_handle_t *command_queue) {
   assert(this->device != nullptr);
@@ -313,6 +384,37 @@ void ZeApp::commandQueueCreate(ze_device_handle_t device,
       this->context, device, &command_queue_description, command_queue));
 }
 
+void ZeApp::commandQueueCreate(ze_device_handle_t device,
+                               const uint32_t command_queue_group_ordinal,
+                               const uint32_t command_queue_index,
+                               ze_command_queue_handle_t *command_queue) {
+  ze_command_queue_desc_t command_queue_description{};
+  command_queue_description.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+  command_queue_description.pNext = nullptr;
+  command_queue_description.ordinal = command_queue_group_ordinal;
+  command_queue_description.index = command_queue_index;
+  command_queue_description.mode = ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+  SUCCESS_OR_TERMINATE(zeCommandQueueCreate(
+      this->context, device, &command_queue_description, command_queue));
+}
+
+std::vector<ze_command_queue_group_properties_t>
+ZeApp::commandQueueGroupProperties(ze_device_handle_t device) {
+  uint32_t count = 0;
+  SUCCESS_OR_TERMINATE(
+      zeDeviceGetCommandQueueGroupProperties(device, &count, nullptr));
+
+  std::vector<ze_command_queue_group_properties_t> properties(count);
+  for (auto &property : properties) {
+    property.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_GROUP_PROPERTIES;
+    property.pNext = nullptr;
+  }
+  SUCCESS_OR_TERMINATE(zeDeviceGetCommandQueueGroupProperties(
+      device, &count, properties.data()));
+  return properties;
+}
+
 void ZeApp::commandQueueDestroy(ze_command_queue_handle_t command_queue) {
   SUCCESS_OR_TERMINATE(zeCommandQueueDestroy(command_queue));
 }
@@ -0,0 +1,56 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#ifndef ZE_BANDWIDTH_VERIFY_HPP
+#define ZE_BANDWIDTH_VERIFY_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+/* Returns the offset of the first byte that differs, or size if none does */
+size_t compare_buffers(const uint8_t *expected, const uint8_t *actual,
+                       size_t size);
+
+//---------------------------------------------------------------------
+// Compares received buffers against the transmitted buffer on its own
+// thread, so that a check overlaps the next transfer. The first and
+// last bytes are compared against the values they had when the transfer
+// was submitted, since the next iteration rewrites them.
+//---------------------------------------------------------------------
+class VerifyThread {
+public:
+  VerifyThread();
+  ~VerifyThread();
+  void post(const uint8_t *expected, const uint8_t *actual, size_t size,
+            uint8_t first, uint8_t last);
+  void wait();
+
+private:
+  void run();
+
+  std::mutex mutex;
+  std::condition_variable condition;
+  bool pending = false;
+  bool stopping = false;
+  bool failed = false;
+  size_t mismatch = 0;
+
+  const uint8_t *expected = nullptr;
+  const uint8_t *actual = nullptr;
+  size_t size = 0;
+  uint8_t first = 0;
+  uint8_t last = 0;
+
+  /* Last, so that it starts once the state above is initialized */
+  std::thread worker;
+};
+
+#endif /* ZE_BANDWIDTH_VERIFY_HPP */
@@ -9,6 +9,25 @@
 #include <chrono>
 #include <level_zero/ze_api.h>
 #include "ze_app.hpp"
+#include "verify.hpp"
+
+/* Kinds of memory a transfer can read from or write to */
+enum class MemoryType { HOST, DEVICE, SHARED, SYSTEM };
+
+/* A queue of a copy capable group with the command list it executes */
+struct CopyStream {
+  uint32_t ordinal;
+  uint32_t index;
+  ze_command_queue_handle_t command_queue;
+  ze_command_list_handle_t command_list;
+};
+
+/* Bandwidth of each direction over one window of a soak test */
+struct SoakWindow {
+  long double elapsed_s;
+  long double host2dev_bandwidth;
+  long double dev2host_bandwidth;
+};
 
 class ZeBandwidth {
 public:
@@ -17,13 +36,37 @@ public:
   int parse_arguments(int argc, char **argv);
   void test_host2device(void);
   void test_device2host(void);
+  void test_bidirectional(void);
+  void test_copy_streams(void);
+  void test_memory_matrix(void);
+  void test_submission_latency(void);
+  void test_soak(void);
+  void buffer_pool_create(void);
 
   std::vector<size_t> transfer_size;
   size_t transfer_lower_limit = 1;
   size_t transfer_upper_limit = (1 << 28);
   bool verify = false;
+  /* Compare each transfer on its own thread, overlapping the next one */
+  bool verify_in_thread = false;
   bool run_host2dev = true;
   bool run_dev2host = true;
+  bool run_bidirectional = false;
+  bool run_copy_streams = false;
+  bool run_memory_matrix = false;
+  bool run_submission_latency = false;
+  /* Copies appended to one command list in the batched submission model */
+  uint32_t copies_per_submit = 64;
+  bool run_soak = false;
+  /* Soak mode: total duration, window length and dip threshold */
+  uint32_t soak_duration_s = 60;
+  uint32_t soak_window_ms = 1000;
+  long double soak_dip_fraction = 0.9;
+  /* CSV file for the soak time series, standard output when empty */
+  std::string soak_output;
+  /* Hand out sub-ranges of buffers allocated once at the largest size */
+  bool use_buffer_pool = true;
+  bool pretouch_buffer_pool = false;
   uint32_t number_iterations = 500;
 
 private:
@@ -41,6 +84,49 @@ private:
   void print_results_device2host(size_t buffer_size,
                                  long double total_bandwidth,
                                  long double total_latency);
+  void print_results_bidirectional(size_t buffer_size,
+                                   long double total_bandwidth);
+  uint32_t copy_only_queue_group_ordinal(
+      const std::vector<ze_command_queue_group_properties_t> &groups);
+  uint32_t compute_queue_group_ordinal(
+      const std::vector<ze_command_queue_group_properties_t> &groups);
+  void bidirectional_queues_create(void);
+  void bidirectional_queues_destroy(void);
+  void measure_transfer_bidirectional(uint32_t num_transfer,
+                                      long double &host2dev_time_nsec,
+                                      long double &dev2host_time_nsec,
+                                      long double &total_time_nsec);
+  void print_results_copy_streams(const char *direction, size_t buffer_size,
+                                  uint32_t number_streams,
+                                  long double total_bandwidth,
+                                  long double scaling);
+  void copy_streams_create(void);
+  void copy_streams_destroy(void);
+  long double measure_transfer_streams(uint32_t number_streams,
+                                       uint32_t num_transfer);
+  long double streams_size_test(size_t size, void *destination_buffer,
+                                void *source_buffer, uint32_t number_streams);
+  void copy_streams_sweep(const char *direction, bool host2dev);
+  void buffer_pool_pretouch(void);
+  void buffer_pool_destroy(void);
+  void buffers_acquire(size_t size, uint32_t slot, void **device,
+                       void **host, void **host_verify = nullptr,
+                       void **host_verify_alt = nullptr);
+  void buffers_release(void *device, void *host, void *host_verify = nullptr,
+                       void *host_verify_alt = nullptr);
+  void *memory_type_alloc(MemoryType type, size_t size);
+  void memory_type_free(MemoryType type, void *buffer);
+  void print_results_memory_matrix(size_t buffer_size,
+                                   const std::vector<long double> &bandwidth,
+                                   const std::vector<long double> &latency);
+  void print_results_submission(size_t buffer_size, const char *model,
+                                long double latency);
+  long double measure_immediate_copy(ze_command_list_handle_t immediate_list,
+                                     ze_event_handle_t event, size_t size);
+  long double measure_batched_copy(size_t size);
+  SoakWindow measure_soak_window(size_t size, long double elapsed_s);
+  void print_results_soak(std::ostream &out,
+                          const std::vector<SoakWindow> &windows);
   void calculate_metrics(long double total_time_nsec, /* Units in nanoseconds */
                          long double total_data_transfer, /* Units in bytes */
                          long double &total_bandwidth,
@@ -49,7 +135,30 @@ private:
   ze_command_queue_handle_t command_queue;
   ze_command_list_handle_t command_list;
   ze_command_list_handle_t command_list_verify;
+  /* Second receive list and buffer, used in turn when verifying in thread */
+  ze_command_list_handle_t command_list_verify_alt;
   void *device_buffer;
   void *host_buffer;
   void *host_buffer_verify;
+  void *host_buffer_verify_alt = nullptr;
+
+  /* Bidirectional mode: one queue and command list per direction */
+  ze_command_queue_handle_t host2dev_queue;
+  ze_command_queue_handle_t dev2host_queue;
+  ze_command_list_handle_t host2dev_list;
+  ze_command_list_handle_t dev2host_list;
+  ze_event_pool_handle_t bidirectional_event_pool;
+  ze_event_handle_t host2dev_event;
+  ze_event_handle_t dev2host_event;
+
+  /* Buffer pool: one slot per set of buffers in use at the same time */
+  static const uint32_t buffer_pool_slots = 2;
+  size_t buffer_pool_size = 0;
+  void *pool_device_buffer[buffer_pool_slots] = {};
+  void *pool_host_buffer[buffer_pool_slots] = {};
+  void *pool_host_buffer_verify = nullptr;
+  void *pool_host_buffer_verify_alt = nullptr;
+
+  /* Multi-stream mode: every queue of every copy capable group */
+  std::vector<CopyStream> copy_streams;
 };
@@ -15,9 +15,40 @@ static const char *usage_str =
     "\n  -t, string               selectively run a particular test:"
     "\n      h2d or H2D                       run only Host-to-Device tests"
     "\n      d2h or D2H                       run only Device-to-Host tests "
+    "\n      bidir or BIDIR                   run only the bidirectional test,"
+    "\n                                       with Host-to-Device and"
+    "\n                                       Device-to-Host transfers at the"
+    "\n                                       same time"
+    "\n      streams or STREAMS               run only the multi-stream test,"
+    "\n                                       splitting each transfer over 1"
+    "\n                                       to N copy capable queues"
+    "\n      matrix or MATRIX                 run only the memory type matrix,"
+    "\n                                       copying between host, device,"
+    "\n                                       shared and system memory"
+    "\n      submit or SUBMIT                 run only the submission latency"
+    "\n                                       test, comparing queues, immediate"
+    "\n                                       command lists and batched copies"
+    "\n      soak or SOAK                     run only the soak test, repeating"
+    "\n                                       the largest transfer size and"
+    "\n                                       writing a CSV time series"
     "\n                            [default:  both]"
-    "\n  -v                       enable verificaton"
+    "\n  -v                       enable verificaton of every byte of"
+    "\n                           every transfer"
     "\n                            [default:  disabled]"
+    "\n  -vt                      enable verification, comparing on a"
+    "\n                           separate thread that overlaps the next"
+    "\n                           transfer"
+    "\n                            [default:  disabled]"
+    "\n  -a                       allocate and free the buffers of every"
+    "\n                           transfer size instead of using the"
+    "\n                           buffer pool"
+    "\n                            [default:  disabled]"
+    "\n  -p                       pre-touch the buffer pool and report the"
+    "\n                           first touch times"
+    "\n                            [default:  disabled]"
+    "\n  -b                       set number of copies per submission in"
+    "\n                           the batched submission model"
+    "\n                            [default:  64]"
     "\n  -i                       set number of iterations per transfer"
     "\n                            [default:  500]"
     "\n  -s                       select only one transfer size (bytes) "
@@ -25,6 +56,15 @@ static const char *usage_str =
     "\n                            [default:  1]"
     "\n  -se                      select ending transfer size (bytes)"
     "\n                            [default: 2^30]"
+    "\n  -d                       set soak test duration (seconds)"
+    "\n                            [default:  60]"
+    "\n  -w                       set soak test window (milliseconds)"
+    "\n                            [default:  1000]"
+    "\n  -f                       flag soak windows below this fraction of"
+    "\n                           the median bandwidth"
+    "\n                            [default:  0.9]"
+    "\n  -o                       write the soak time series to a CSV file"
+    "\n                            [default:  standard output]"
     "\n  -h, --help               display help message"
     "\n";
 
@@ -52,6 +92,22 @@ int ZeBandwidth::parse_arguments(int argc, char **argv) {
       exit(0);
     } else if (strcmp(argv[i], "-v") == 0) {
       verify = true;
+    } else if (strcmp(argv[i], "-vt") == 0) {
+      verify = true;
+      verify_in_thread = true;
+    } else if (strcmp(argv[i], "-a") == 0) {
+      use_buffer_pool = false;
+    } else if (strcmp(argv[i], "-p") == 0) {
+      pretouch_buffer_pool = true;
+    } else if (strcmp(argv[i], "-b") == 0) {
+      if ((i + 1) < argc) {
+        copies_per_submit = sanitize_ulong(argv[i + 1]);
+        i++;
+      }
+      if (copies_per_submit == 0) {
+        std::cout << usage_str;
+        exit(-1);
+      }
     } else if (strcmp(argv[i], "-i") == 0) {
       if ((i + 1) < argc) {
         number_iterations = sanitize_ulong(argv[i + 1]);
@@ -73,6 +129,34 @@ int ZeBandwidth::parse_arguments(int argc, char **argv) {
         transfer_upper_limit = sanitize_ulong(argv[i + 1]);
         i++;
       }
+    } else if (strcmp(argv[i], "-d") == 0) {
+      if ((i + 1) < argc) {
+        soak_duration_s = sanitize_ulong(argv[i + 1]);
+        i++;
+      }
+    } else if (strcmp(argv[i], "-w") == 0) {
+      if ((i + 1) < argc) {
+        soak_window_ms = sanitize_ulong(argv[i + 1]);
+        i++;
+      }
+      if (soak_window_ms == 0) {
+        std::cout << usage_str;
+        exit(-1);
+      }
+    } else if (strcmp(argv[i], "-f") == 0) {
+      if ((i + 1) < argc) {
+        soak_dip_fraction = strtold(argv[i + 1], NULL);
+        i++;
+      }
+      if ((soak_dip_fraction <= 0) || (soak_dip_fraction > 1)) {
+        std::cout << usage_str;
+        exit(-1);
+      }
+    } else if (strcmp(argv[i], "-o") == 0) {
+      if ((i + 1) < argc) {
+        soak_output = argv[i + 1];
+        i++;
+      }
     } else if ((strcmp(argv[i], "-t") == 0)) {
       run_host2dev = false;
       run_dev2host = false;
@@ -89,6 +173,26 @@ int ZeBandwidth::parse_arguments(int argc, char **argv) {
                  (strcmp(argv[i + 1], "D2H") == 0)) {
         run_dev2host = true;
         i++;
+      } else if ((strcmp(argv[i + 1], "bidir") == 0) ||
+                 (strcmp(argv[i + 1], "BIDIR") == 0)) {
+        run_bidirectional = true;
+        i++;
+      } else if ((strcmp(argv[i + 1], "streams") == 0) ||
+                 (strcmp(argv[i + 1], "STREAMS") == 0)) {
+        run_copy_streams = true;
+        i++;
+      } else if ((strcmp(argv[i + 1], "matrix") == 0) ||
+                 (strcmp(argv[i + 1], "MATRIX") == 0)) {
+        run_memory_matrix = true;
+        i++;
+      } else if ((strcmp(argv[i + 1], "submit") == 0) ||
+                 (strcmp(argv[i + 1], "SUBMIT") == 0)) {
+        run_submission_latency = true;
+        i++;
+      } else if ((strcmp(argv[i + 1], "soak") == 0) ||
+                 (strcmp(argv[i + 1], "SOAK") == 0)) {
+        run_soak = true;
+        i++;
       } else {
         std::cout << usage_str;
         exit(-1);
@@ -0,0 +1,156 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "verify.hpp"
+
+#include <stdexcept>
+#include <string>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define VERIFY_X86_DISPATCH
+#include <immintrin.h>
+#endif
+
+static size_t compare_scalar(const uint8_t *expected, const uint8_t *actual,
+                             size_t offset, size_t size) {
+  for (; offset < size; offset++) {
+    if (expected[offset] != actual[offset]) {
+      break;
+    }
+  }
+  return offset;
+}
+
+#ifdef VERIFY_X86_DISPATCH
+//---------------------------------------------------------------------
+// The vector loops stop at the first block that differs and leave the
+// exact offset to the scalar loop, which also handles the tail.
+//---------------------------------------------------------------------
+__attribute__((target("sse2"))) static size_t
+compare_sse2(const uint8_t *expected, const uint8_t *actual, size_t size) {
+  size_t offset = 0;
+
+  for (; offset + 16 <= size; offset += 16) {
+    __m128i x = _mm_loadu_si128(
+        reinterpret_cast<const __m128i *>(expected + offset));
+    __m128i y =
+        _mm_loadu_si128(reinterpret_cast<const __m128i *>(actual + offset));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) != 0xffff) {
+      break;
+    }
+  }
+  return compare_scalar(expected, actual, offset, size);
+}
+
+__attribute__((target("avx2"))) static size_t
+compare_avx2(const uint8_t *expected, const uint8_t *actual, size_t size) {
+  size_t offset = 0;
+
+  for (; offset + 64 <= size; offset += 64) {
+    __m256i x0 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(expected + offset));
+    __m256i x1 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(expected + offset + 32));
+    __m256i y0 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(actual + offset));
+    __m256i y1 = _mm256_loadu_si256(
+        reinterpret_cast<const __m256i *>(actual + offset + 32));
+    __m256i diff =
+        _mm256_or_si256(_mm256_xor_si256(x0, y0), _mm256_xor_si256(x1, y1));
+    if (!_mm256_testz_si256(diff, diff)) {
+      break;
+    }
+  }
+  return compare_scalar(expected, actual, offset, size);
+}
+#endif
+
+size_t compare_buffers(const uint8_t *expected, const uint8_t *actual,
+                       size_t size) {
+#ifdef VERIFY_X86_DISPATCH
+  static const bool has_avx2 = __builtin_cpu_supports("avx2");
+  static const bool has_sse2 = __builtin_cpu_supports("sse2");
+
+  if (has_avx2) {
+    return compare_avx2(expected, actual, size);
+  }
+  if (has_sse2) {
+    return compare_sse2(expected, actual, size);
+  }
+#endif
+  return compare_scalar(expected, actual, 0, size);
+}
+
+VerifyThread::VerifyThread() : worker(&VerifyThread::run, this) {}
+
+VerifyThread::~VerifyThread() {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  condition.notify_all();
+  worker.join();
+}
+
+void VerifyThread::post(const uint8_t *expected, const uint8_t *actual,
+                        size_t size, uint8_t first, uint8_t last) {
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    this->expected = expected;
+    this->actual = actual;
+    this->size = size;
+    this->first = first;
+    this->last = last;
+    pending = true;
+  }
+  condition.notify_all();
+}
+
+//---------------------------------------------------------------------
+// Waits for the posted comparison to finish, and throws if it found a
+// difference.
+//---------------------------------------------------------------------
+void VerifyThread::wait() {
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this] { return !pending; });
+  if (failed) {
+    failed = false;
+    throw std::runtime_error("Host memory verification failed at offset " +
+                             std::to_string(mismatch));
+  }
+}
+
+void VerifyThread::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+
+  while (true) {
+    condition.wait(lock, [this] { return pending || stopping; });
+    if (stopping) {
+      return;
+    }
+
+    lock.unlock();
+    size_t offset = size;
+    if ((actual[0] != first) || (actual[size - 1] != last)) {
+      offset = (actual[0] != first) ? 0 : size - 1;
+    } else if (size > 2) {
+      offset = compare_buffers(expected + 1, actual + 1, size - 2) + 1;
+      if (offset == size - 1) {
+        offset = size;
+      }
+    }
+    lock.lock();
+
+    if (offset != size) {
+      failed = true;
+      mismatch = offset;
+    }
+    pending = false;
+    condition.notify_all();
+  }
+}
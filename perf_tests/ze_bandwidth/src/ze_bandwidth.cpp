@@ -12,9 +12,14 @@
 #include "ze_app.hpp"
 #include "ze_bandwidth.hpp"
 
+#include <algorithm>
 #include <assert.h>
+#include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <memory>
+#include <string>
 
 ZeBandwidth::ZeBandwidth() {
   benchmark = new ZeApp();
@@ -24,10 +29,13 @@ ZeBandwidth::ZeBandwidth() {
   benchmark->commandQueueCreate(0, &command_queue);
   benchmark->commandListCreate(&command_list);
   benchmark->commandListCreate(&command_list_verify);
+  benchmark->commandListCreate(&command_list_verify_alt);
 }
 
 ZeBandwidth::~ZeBandwidth() {
 
+  buffer_pool_destroy();
+  benchmark->commandListDestroy(command_list_verify_alt);
   benchmark->commandListDestroy(command_list_verify);
   benchmark->commandListDestroy(command_list);
   benchmark->commandQueueDestroy(command_queue);
@@ -36,6 +44,165 @@ ZeBandwidth::~ZeBandwidth() {
   delete benchmark;
 }
 
+//---------------------------------------------------------------------
+// Allocates the buffer pool at the largest transfer size: a device and a
+// host buffer per slot, the second slot only for the bidirectional test,
+// and host verification buffers when verification is enabled for the
+// Host->Device or Device->Host test. Nothing is allocated when none of
+// the selected tests takes its buffers from the pool.
+//---------------------------------------------------------------------
+void ZeBandwidth::buffer_pool_create(void) {
+  bool pool_used = run_host2dev || run_dev2host || run_bidirectional ||
+                   run_copy_streams || run_submission_latency || run_soak;
+  bool verify_used = run_host2dev || run_dev2host;
+
+  if (!use_buffer_pool || !pool_used || transfer_size.empty()) {
+    return;
+  }
+
+  buffer_pool_size = transfer_size.back();
+  uint32_t slots = 1;
+  if (run_bidirectional) {
+    slots = buffer_pool_slots;
+  }
+  for (uint32_t slot = 0; slot < slots; slot++) {
+    benchmark->memoryAlloc(buffer_pool_size, &pool_device_buffer[slot]);
+    benchmark->memoryAllocHost(buffer_pool_size, &pool_host_buffer[slot]);
+  }
+  if (verify && verify_used) {
+    benchmark->memoryAllocHost(buffer_pool_size, &pool_host_buffer_verify);
+  }
+  if (verify_in_thread && verify_used) {
+    benchmark->memoryAllocHost(buffer_pool_size,
+                               &pool_host_buffer_verify_alt);
+  }
+
+  if (pretouch_buffer_pool) {
+    buffer_pool_pretouch();
+  }
+}
+
+//---------------------------------------------------------------------
+// Writes every pool buffer once, so that the tests do not see first
+// touch page faults, and reports how long this first touch took.
+//---------------------------------------------------------------------
+void ZeBandwidth::buffer_pool_pretouch(void) {
+  Timer<std::chrono::nanoseconds::period> timer;
+  long double host_time_nsec = 0.0;
+  long double device_time_nsec = 0.0;
+
+  for (uint32_t slot = 0; slot < buffer_pool_slots; slot++) {
+    if (pool_host_buffer[slot] == nullptr) {
+      continue;
+    }
+
+    timer.start();
+    memset(pool_host_buffer[slot], 0, buffer_pool_size);
+    timer.end();
+    host_time_nsec += timer.period_minus_overhead();
+
+    benchmark->commandListAppendMemoryCopy(command_list,
+                                           pool_device_buffer[slot],
+                                           pool_host_buffer[slot],
+                                           buffer_pool_size);
+    benchmark->commandListClose(command_list);
+    timer.start();
+    benchmark->commandQueueExecuteCommandList(command_queue, 1, &command_list);
+    benchmark->commandQueueSynchronize(command_queue);
+    timer.end();
+    device_time_nsec += timer.period_minus_overhead();
+    benchmark->commandListReset(command_list);
+  }
+  if (pool_host_buffer_verify != nullptr) {
+    timer.start();
+    memset(pool_host_buffer_verify, 0, buffer_pool_size);
+    timer.end();
+    host_time_nsec += timer.period_minus_overhead();
+  }
+  if (pool_host_buffer_verify_alt != nullptr) {
+    timer.start();
+    memset(pool_host_buffer_verify_alt, 0, buffer_pool_size);
+    timer.end();
+    host_time_nsec += timer.period_minus_overhead();
+  }
+
+  std::cout << "First touch[" << std::fixed << std::setw(10)
+            << buffer_pool_size << "]:  Host = " << std::setw(9)
+            << std::setprecision(2) << host_time_nsec / 1e3
+            << " usec  Device = " << std::setw(9) << device_time_nsec / 1e3
+            << " usec" << std::endl;
+}
+
+void ZeBandwidth::buffer_pool_destroy(void) {
+  for (uint32_t slot = 0; slot < buffer_pool_slots; slot++) {
+    if (pool_device_buffer[slot] != nullptr) {
+      benchmark->memoryFree(pool_device_buffer[slot]);
+      benchmark->memoryFree(pool_host_buffer[slot]);
+      pool_device_buffer[slot] = nullptr;
+      pool_host_buffer[slot] = nullptr;
+    }
+  }
+  if (pool_host_buffer_verify != nullptr) {
+    benchmark->memoryFree(pool_host_buffer_verify);
+    pool_host_buffer_verify = nullptr;
+  }
+  if (pool_host_buffer_verify_alt != nullptr) {
+    benchmark->memoryFree(pool_host_buffer_verify_alt);
+    pool_host_buffer_verify_alt = nullptr;
+  }
+}
+
+//---------------------------------------------------------------------
+// Returns the buffers for a transfer of size bytes: the start of the
+// pool buffers of the given slot, or new allocations when the pool is
+// disabled. host_verify and host_verify_alt are only set when they are
+// not null.
+//---------------------------------------------------------------------
+void ZeBandwidth::buffers_acquire(size_t size, uint32_t slot, void **device,
+                                  void **host, void **host_verify,
+                                  void **host_verify_alt) {
+  if (use_buffer_pool) {
+    assert(size <= buffer_pool_size);
+    assert(pool_device_buffer[slot] != nullptr);
+    *device = pool_device_buffer[slot];
+    *host = pool_host_buffer[slot];
+    if (host_verify != nullptr) {
+      assert(pool_host_buffer_verify != nullptr);
+      *host_verify = pool_host_buffer_verify;
+    }
+    if (host_verify_alt != nullptr) {
+      assert(pool_host_buffer_verify_alt != nullptr);
+      *host_verify_alt = pool_host_buffer_verify_alt;
+    }
+    return;
+  }
+
+  benchmark->memoryAlloc(size, device);
+  benchmark->memoryAllocHost(size, host);
+  if (host_verify != nullptr) {
+    benchmark->memoryAllocHost(size, host_verify);
+  }
+  if (host_verify_alt != nullptr) {
+    benchmark->memoryAllocHost(size, host_verify_alt);
+  }
+}
+
+void ZeBandwidth::buffers_release(void *device, void *host, void *host_verify,
+                                  void *host_verify_alt) {
+  if (use_buffer_pool) {
+    return;
+  }
+
+  benchmark->memoryFree(device);
+  benchmark->memoryFree(host);
+  if (host_verify != nullptr) {
+    benchmark->memoryFree(host_verify);
+  }
+  if (host_verify_alt != nullptr) {
+    benchmark->memoryFree(host_verify_alt);
+  }
+}
+
 void ZeBandwidth::calculate_metrics(
     long double total_time_nsec,     /* Units in nanoseconds */
     long double total_data_transfer, /* Units in bytes */
@@ -67,18 +234,42 @@ void ZeBandwidth::print_results_device2host(size_t buffer_size,
             << std::setprecision(2) << total_latency << " usec" << std::endl;
 }
 
+void ZeBandwidth::print_results_bidirectional(size_t buffer_size,
+                                              long double total_bandwidth) {
+  std::cout << "Bidirectional[" << std::fixed << std::setw(10) << buffer_size
+            << "]:  BW = " << std::setw(9) << std::setprecision(6)
+            << total_bandwidth << " GBPS  (aggregate)" << std::endl;
+}
+
+//---------------------------------------------------------------------
+// Times Host->Device and Device->Host transfers of the host buffer and
+// compares every received byte with it. With verify_in_thread the check
+// of one iteration overlaps the transfers of the next one, which write
+// the other receive buffer.
+//---------------------------------------------------------------------
 void ZeBandwidth::measure_transfer_verify(size_t buffer_size,
                                           uint32_t num_transfer,
                                           long double &host2dev_time_nsec,
                                           long double &dev2host_time_nsec) {
   Timer<std::chrono::nanoseconds::period> timer;
+  std::unique_ptr<VerifyThread> verifier;
 
   uint8_t *xmt = static_cast<uint8_t *>(host_buffer);
-  uint8_t *rcv = static_cast<uint8_t *>(host_buffer_verify);
   host2dev_time_nsec = 0.0;
   dev2host_time_nsec = 0.0;
 
+  if (verify_in_thread) {
+    verifier.reset(new VerifyThread());
+  }
+
   for (uint32_t i = 0; i < num_transfer; i++) {
+    ze_command_list_handle_t receive_list = command_list_verify;
+    uint8_t *rcv = static_cast<uint8_t *>(host_buffer_verify);
+    if (verify_in_thread && (i & 1)) {
+      receive_list = command_list_verify_alt;
+      rcv = static_cast<uint8_t *>(host_buffer_verify_alt);
+    }
+
     xmt[0] = rand() & 0xff;
     xmt[buffer_size - 1] = rand() & 0xff;
 
@@ -90,19 +281,26 @@ void ZeBandwidth::measure_transfer_verify(size_t buffer_size,
 
     timer.start();
     benchmark->commandQueueExecuteCommandList(command_queue, 1,
-                                              &command_list_verify);
+                                              &receive_list);
     benchmark->commandQueueSynchronize(command_queue);
     timer.end();
     dev2host_time_nsec += timer.period_minus_overhead();
 
-    // Comparing all transfer bytes results in significant increase in
-    // execution time
-    //(likely due to cache invalidation and flushing effects)
-    // To minimize this penalty only verify first and last byte of transfer.
-    if ((xmt[0] != rcv[0]) || (xmt[buffer_size - 1] != rcv[buffer_size - 1])) {
-      throw std::runtime_error("Host memory verification failed ");
+    if (verify_in_thread) {
+      verifier->wait();
+      verifier->post(xmt, rcv, buffer_size, xmt[0], xmt[buffer_size - 1]);
+    } else {
+      size_t mismatch = compare_buffers(xmt, rcv, buffer_size);
+      if (mismatch != buffer_size) {
+        throw std::runtime_error("Host memory verification failed at offset " +
+                                 std::to_string(mismatch));
+      }
     }
   }
+
+  if (verify_in_thread) {
+    verifier->wait();
+  }
 }
 
 long double ZeBandwidth::measure_transfer(uint32_t num_transfer) {
@@ -131,12 +329,27 @@ void ZeBandwidth::transfer_size_test_verify(size_t size,
   benchmark->commandListAppendMemoryCopy(
       command_list_verify, host_buffer_verify, device_buffer, buffer_size);
   benchmark->commandListClose(command_list_verify);
+  if (verify_in_thread) {
+    benchmark->commandListAppendMemoryCopy(command_list_verify_alt,
+                                           host_buffer_verify_alt,
+                                           device_buffer, buffer_size);
+    benchmark->commandListClose(command_list_verify_alt);
+  }
+
+  /* A pattern that differs between sizes, so a stale buffer is detected */
+  uint8_t *xmt = static_cast<uint8_t *>(host_buffer);
+  for (size_t i = 0; i < buffer_size; i++) {
+    xmt[i] = static_cast<uint8_t>(i * 7 + size);
+  }
 
   measure_transfer_verify(buffer_size, number_iterations, host2dev_time_nsec,
                           dev2host_time_nsec);
 
   benchmark->commandListReset(command_list);
   benchmark->commandListReset(command_list_verify);
+  if (verify_in_thread) {
+    benchmark->commandListReset(command_list_verify_alt);
+  }
 }
 
 void ZeBandwidth::transfer_size_test(size_t size, void *destination_buffer,
@@ -169,15 +382,14 @@ void ZeBandwidth::test_host2device(void) {
       long double total_bandwidth;
       long double total_latency;
 
-      benchmark->memoryAlloc(size, &device_buffer);
-      benchmark->memoryAllocHost(size, &host_buffer);
-      benchmark->memoryAllocHost(size, &host_buffer_verify);
+      buffers_acquire(size, 0, &device_buffer, &host_buffer,
+                      &host_buffer_verify,
+                      verify_in_thread ? &host_buffer_verify_alt : nullptr);
 
       transfer_size_test_verify(size, host2dev_time_nsec, dev2host_time_nsec);
 
-      benchmark->memoryFree(device_buffer);
-      benchmark->memoryFree(host_buffer);
-      benchmark->memoryFree(host_buffer_verify);
+      buffers_release(device_buffer, host_buffer, host_buffer_verify,
+                      host_buffer_verify_alt);
 
       calculate_metrics(host2dev_time_nsec,
                         static_cast<long double>(size * number_iterations),
@@ -189,13 +401,11 @@ void ZeBandwidth::test_host2device(void) {
     for (auto size : transfer_size) {
       long double total_time_nsec;
 
-      benchmark->memoryAlloc(size, &device_buffer);
-      benchmark->memoryAllocHost(size, &host_buffer);
+      buffers_acquire(size, 0, &device_buffer, &host_buffer);
 
       transfer_size_test(size, device_buffer, host_buffer, total_time_nsec);
 
-      benchmark->memoryFree(device_buffer);
-      benchmark->memoryFree(host_buffer);
+      buffers_release(device_buffer, host_buffer);
 
       calculate_metrics(total_time_nsec,
                         static_cast<long double>(size * number_iterations),
@@ -219,15 +429,14 @@ void ZeBandwidth::test_device2host(void) {
       long double total_bandwidth;
       long double total_latency;
 
-      benchmark->memoryAlloc(size, &device_buffer);
-      benchmark->memoryAllocHost(size, &host_buffer);
-      benchmark->memoryAllocHost(size, &host_buffer_verify);
+      buffers_acquire(size, 0, &device_buffer, &host_buffer,
+                      &host_buffer_verify,
+                      verify_in_thread ? &host_buffer_verify_alt : nullptr);
 
       transfer_size_test_verify(size, host2dev_time_nsec, dev2host_time_nsec);
 
-      benchmark->memoryFree(device_buffer);
-      benchmark->memoryFree(host_buffer);
-      benchmark->memoryFree(host_buffer_verify);
+      buffers_release(device_buffer, host_buffer, host_buffer_verify,
+                      host_buffer_verify_alt);
 
       calculate_metrics(dev2host_time_nsec,
                         static_cast<long double>(size * number_iterations),
@@ -239,13 +448,11 @@ void ZeBandwidth::test_device2host(void) {
     for (auto size : transfer_size) {
       long double total_time_nsec;
 
-      benchmark->memoryAlloc(size, &device_buffer);
-      benchmark->memoryAllocHost(size, &host_buffer);
+      buffers_acquire(size, 0, &device_buffer, &host_buffer);
 
       transfer_size_test(size, host_buffer, device_buffer, total_time_nsec);
 
-      benchmark->memoryFree(device_buffer);
-      benchmark->memoryFree(host_buffer);
+      buffers_release(device_buffer, host_buffer);
 
       calculate_metrics(total_time_nsec,
                         static_cast<long double>(size * number_iterations),
@@ -255,6 +462,775 @@ void ZeBandwidth::test_device2host(void) {
   }
 }
 
+//---------------------------------------------------------------------
+// Returns the ordinal of the first command queue group with copy engines
+// only, or the number of groups if there is none.
+//---------------------------------------------------------------------
+uint32_t ZeBandwidth::copy_only_queue_group_ordinal(
+    const std::vector<ze_command_queue_group_properties_t> &groups) {
+  for (uint32_t i = 0; i < groups.size(); i++) {
+    if ((groups[i].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) &&
+        !(groups[i].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) &&
+        (groups[i].numQueues > 0)) {
+      return i;
+    }
+  }
+  return static_cast<uint32_t>(groups.size());
+}
+
+//---------------------------------------------------------------------
+// Returns the ordinal of the first command queue group with compute
+// engines, or the number of groups if there is none.
+//---------------------------------------------------------------------
+uint32_t ZeBandwidth::compute_queue_group_ordinal(
+    const std::vector<ze_command_queue_group_properties_t> &groups) {
+  for (uint32_t i = 0; i < groups.size(); i++) {
+    if ((groups[i].flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE) &&
+        (groups[i].numQueues > 0)) {
+      return i;
+    }
+  }
+  return static_cast<uint32_t>(groups.size());
+}
+
+//---------------------------------------------------------------------
+// Creates a queue and a command list for each direction, so that both
+// directions can run at the same time. Host->Device and Device->Host use
+// two copy engines when the copy group has two, else the compute group
+// and the copy engine, else two queues of the compute group. A device
+// with a single compute queue and no copy engine runs both directions
+// on that one queue.
+//---------------------------------------------------------------------
+void ZeBandwidth::bidirectional_queues_create(void) {
+  std::vector<ze_command_queue_group_properties_t> groups =
+      benchmark->commandQueueGroupProperties(benchmark->device);
+  uint32_t copy_ordinal = copy_only_queue_group_ordinal(groups);
+  uint32_t compute_ordinal = compute_queue_group_ordinal(groups);
+  if (compute_ordinal == groups.size())
+    compute_ordinal = 0;
+
+  uint32_t host2dev_ordinal = compute_ordinal, host2dev_index = 0;
+  uint32_t dev2host_ordinal = compute_ordinal, dev2host_index = 0;
+  if (copy_ordinal < groups.size()) {
+    dev2host_ordinal = copy_ordinal;
+    if (groups[copy_ordinal].numQueues > 1) {
+      host2dev_ordinal = copy_ordinal;
+      dev2host_index = 1;
+      std::cout << "Using two copy engines" << std::endl;
+    } else {
+      std::cout << "Using the compute engine for Host->Device and the copy "
+                   "engine for Device->Host"
+                << std::endl;
+    }
+  } else if ((compute_ordinal < groups.size()) &&
+             (groups[compute_ordinal].numQueues > 1)) {
+    dev2host_index = 1;
+    std::cout << "No copy engine, using two compute queues" << std::endl;
+  } else {
+    std::cout << "No copy engine and a single compute queue, both directions "
+                 "share it"
+              << std::endl;
+  }
+
+  benchmark->commandQueueCreate(benchmark->device, host2dev_ordinal,
+                                host2dev_index, &host2dev_queue);
+  benchmark->commandQueueCreate(benchmark->device, dev2host_ordinal,
+                                dev2host_index, &dev2host_queue);
+  benchmark->commandListCreate(benchmark->device, host2dev_ordinal,
+                               &host2dev_list);
+  benchmark->commandListCreate(benchmark->device, dev2host_ordinal,
+                               &dev2host_list);
+
+  bidirectional_event_pool =
+      benchmark->create_event_pool(2, ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  benchmark->create_event(bidirectional_event_pool, host2dev_event, 0);
+  benchmark->create_event(bidirectional_event_pool, dev2host_event, 1);
+}
+
+void ZeBandwidth::bidirectional_queues_destroy(void) {
+  benchmark->destroy_event(host2dev_event);
+  benchmark->destroy_event(dev2host_event);
+  benchmark->destroy_event_pool(bidirectional_event_pool);
+  benchmark->commandListDestroy(host2dev_list);
+  benchmark->commandListDestroy(dev2host_list);
+  benchmark->commandQueueDestroy(host2dev_queue);
+  benchmark->commandQueueDestroy(dev2host_queue);
+}
+
+//---------------------------------------------------------------------
+// Submits both directions together num_transfer times. The end of each
+// direction is detected by polling the event signaled by its copy, so
+// that the time of each direction under simultaneous traffic is known
+// as well as the total time.
+//---------------------------------------------------------------------
+void ZeBandwidth::measure_transfer_bidirectional(
+    uint32_t num_transfer, long double &host2dev_time_nsec,
+    long double &dev2host_time_nsec, long double &total_time_nsec) {
+  Timer<std::chrono::nanoseconds::period> host2dev_timer;
+  Timer<std::chrono::nanoseconds::period> dev2host_timer;
+  Timer<std::chrono::nanoseconds::period> total_timer;
+
+  host2dev_time_nsec = 0.0;
+  dev2host_time_nsec = 0.0;
+
+  total_timer.start();
+  for (uint32_t i = 0; i < num_transfer; i++) {
+    bool host2dev_done = false;
+    bool dev2host_done = false;
+
+    /* Each direction is timed from its own submission */
+    host2dev_timer.start();
+    benchmark->commandQueueExecuteCommandList(host2dev_queue, 1,
+                                              &host2dev_list);
+    dev2host_timer.start();
+    benchmark->commandQueueExecuteCommandList(dev2host_queue, 1,
+                                              &dev2host_list);
+    while (!host2dev_done || !dev2host_done) {
+      if (!host2dev_done && benchmark->hostEventQuery(host2dev_event)) {
+        host2dev_timer.end();
+        host2dev_time_nsec += host2dev_timer.period_minus_overhead();
+        host2dev_done = true;
+      }
+      if (!dev2host_done && benchmark->hostEventQuery(dev2host_event)) {
+        dev2host_timer.end();
+        dev2host_time_nsec += dev2host_timer.period_minus_overhead();
+        dev2host_done = true;
+      }
+    }
+    benchmark->commandQueueSynchronize(host2dev_queue);
+    benchmark->commandQueueSynchronize(dev2host_queue);
+    benchmark->hostEventReset(host2dev_event);
+    benchmark->hostEventReset(dev2host_event);
+  }
+  total_timer.end();
+
+  total_time_nsec = total_timer.period_minus_overhead();
+}
+
+//---------------------------------------------------------------------
+// Runs Host->Device and Device->Host transfers of the same size at the
+// same time, on separate buffers and separate queues, and reports the
+// bandwidth of each direction under simultaneous traffic and the
+// aggregate bandwidth.
+//---------------------------------------------------------------------
+void ZeBandwidth::test_bidirectional(void) {
+  std::cout << std::endl;
+  std::cout << "BIDIRECTIONAL HOST-TO-DEVICE AND DEVICE-TO-HOST BANDWIDTH"
+            << std::endl;
+
+  bidirectional_queues_create();
+
+  for (auto size : transfer_size) {
+    long double host2dev_time_nsec;
+    long double dev2host_time_nsec;
+    long double total_time_nsec;
+    long double total_bandwidth;
+    long double total_latency;
+    void *host2dev_device_buffer, *host2dev_host_buffer;
+    void *dev2host_device_buffer, *dev2host_host_buffer;
+
+    buffers_acquire(size, 0, &host2dev_device_buffer, &host2dev_host_buffer);
+    buffers_acquire(size, 1, &dev2host_device_buffer, &dev2host_host_buffer);
+
+    benchmark->commandListAppendMemoryCopy(host2dev_list,
+                                           host2dev_device_buffer,
+                                           host2dev_host_buffer, size,
+                                           host2dev_event);
+    benchmark->commandListClose(host2dev_list);
+    benchmark->commandListAppendMemoryCopy(dev2host_list,
+                                           dev2host_host_buffer,
+                                           dev2host_device_buffer, size,
+                                           dev2host_event);
+    benchmark->commandListClose(dev2host_list);
+
+    measure_transfer_bidirectional(number_iterations, host2dev_time_nsec,
+                                   dev2host_time_nsec, total_time_nsec);
+
+    benchmark->commandListReset(host2dev_list);
+    benchmark->commandListReset(dev2host_list);
+
+    buffers_release(host2dev_device_buffer, host2dev_host_buffer);
+    buffers_release(dev2host_device_buffer, dev2host_host_buffer);
+
+    calculate_metrics(host2dev_time_nsec,
+                      static_cast<long double>(size * number_iterations),
+                      total_bandwidth, total_latency);
+    print_results_host2device(size, total_bandwidth, total_latency);
+    calculate_metrics(dev2host_time_nsec,
+                      static_cast<long double>(size * number_iterations),
+                      total_bandwidth, total_latency);
+    print_results_device2host(size, total_bandwidth, total_latency);
+    calculate_metrics(total_time_nsec,
+                      static_cast<long double>(2 * size * number_iterations),
+                      total_bandwidth, total_latency);
+    print_results_bidirectional(size, total_bandwidth);
+  }
+
+  bidirectional_queues_destroy();
+}
+
+void ZeBandwidth::print_results_copy_streams(const char *direction,
+                                             size_t buffer_size,
+                                             uint32_t number_streams,
+                                             long double total_bandwidth,
+                                             long double scaling) {
+  std::cout << direction << "[" << std::fixed << std::setw(10) << buffer_size
+            << "]:  Streams = " << std::setw(2) << number_streams
+            << "  BW = " << std::setw(9) << std::setprecision(6)
+            << total_bandwidth << " GBPS  Scaling = " << std::setw(5)
+            << std::setprecision(2) << scaling << "x" << std::endl;
+}
+
+//---------------------------------------------------------------------
+// Creates a queue and a command list for every queue of every command
+// queue group with the copy flag. Queues of copy only groups come first,
+// so that the first streams land on distinct copy engines before the
+// compute group is shared.
+//---------------------------------------------------------------------
+void ZeBandwidth::copy_streams_create(void) {
+  std::vector<ze_command_queue_group_properties_t> groups =
+      benchmark->commandQueueGroupProperties(benchmark->device);
+
+  for (int copy_only = 1; copy_only >= 0; copy_only--) {
+    for (uint32_t ordinal = 0; ordinal < groups.size(); ordinal++) {
+      const ze_command_queue_group_properties_t &group = groups[ordinal];
+      bool is_copy_only =
+          (group.flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) &&
+          !(group.flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COMPUTE);
+
+      if (!(group.flags & ZE_COMMAND_QUEUE_GROUP_PROPERTY_FLAG_COPY) ||
+          (is_copy_only != (copy_only == 1))) {
+        continue;
+      }
+      std::cout << "Queue group " << ordinal << ": " << group.numQueues
+                << (is_copy_only ? " copy" : " compute") << " queue(s)"
+                << std::endl;
+      for (uint32_t index = 0; index < group.numQueues; index++) {
+        CopyStream stream;
+        stream.ordinal = ordinal;
+        stream.index = index;
+        benchmark->commandQueueCreate(benchmark->device, ordinal, index,
+                                      &stream.command_queue);
+        benchmark->commandListCreate(benchmark->device, ordinal,
+                                     &stream.command_list);
+        copy_streams.push_back(stream);
+      }
+    }
+  }
+}
+
+void ZeBandwidth::copy_streams_destroy(void) {
+  for (auto &stream : copy_streams) {
+    benchmark->commandListDestroy(stream.command_list);
+    benchmark->commandQueueDestroy(stream.command_queue);
+  }
+  copy_streams.clear();
+}
+
+//---------------------------------------------------------------------
+// Submits the command lists of the first number_streams streams, then
+// waits for all of them, num_transfer times.
+//---------------------------------------------------------------------
+long double ZeBandwidth::measure_transfer_streams(uint32_t number_streams,
+                                                  uint32_t num_transfer) {
+  Timer<std::chrono::nanoseconds::period> timer;
+
+  timer.start();
+  for (uint32_t i = 0; i < num_transfer; i++) {
+    for (uint32_t s = 0; s < number_streams; s++) {
+      benchmark->commandQueueExecuteCommandList(
+          copy_streams[s].command_queue, 1, &copy_streams[s].command_list);
+    }
+    for (uint32_t s = 0; s < number_streams; s++) {
+      benchmark->commandQueueSynchronize(copy_streams[s].command_queue);
+    }
+  }
+  timer.end();
+
+  return timer.period_minus_overhead();
+}
+
+//---------------------------------------------------------------------
+// Splits a transfer of size bytes into number_streams contiguous chunks,
+// the last one taking the remainder, and copies each chunk on its own
+// stream. Returns the time of number_iterations complete transfers.
+//---------------------------------------------------------------------
+long double ZeBandwidth::streams_size_test(size_t size,
+                                           void *destination_buffer,
+                                           void *source_buffer,
+                                           uint32_t number_streams) {
+  size_t chunk_size = size / number_streams;
+  long double total_time_nsec;
+
+  for (uint32_t s = 0; s < number_streams; s++) {
+    size_t offset = s * chunk_size;
+    size_t length = (s == number_streams - 1) ? (size - offset) : chunk_size;
+
+    benchmark->commandListAppendMemoryCopy(
+        copy_streams[s].command_list,
+        static_cast<uint8_t *>(destination_buffer) + offset,
+        static_cast<uint8_t *>(source_buffer) + offset, length);
+    benchmark->commandListClose(copy_streams[s].command_list);
+  }
+
+  total_time_nsec = measure_transfer_streams(number_streams, number_iterations);
+
+  for (uint32_t s = 0; s < number_streams; s++) {
+    benchmark->commandListReset(copy_streams[s].command_list);
+  }
+
+  return total_time_nsec;
+}
+
+//---------------------------------------------------------------------
+// Measures every transfer size with 1 to N streams, and reports the
+// bandwidth of each stream count relative to one stream.
+//---------------------------------------------------------------------
+void ZeBandwidth::copy_streams_sweep(const char *direction, bool host2dev) {
+  for (auto size : transfer_size) {
+    long double single_stream_bandwidth = 0.0;
+    uint32_t max_streams = static_cast<uint32_t>(copy_streams.size());
+
+    if (size < max_streams) {
+      max_streams = static_cast<uint32_t>(size);
+    }
+
+    buffers_acquire(size, 0, &device_buffer, &host_buffer);
+
+    for (uint32_t n = 1; n <= max_streams; n++) {
+      long double total_time_nsec;
+      long double total_bandwidth;
+      long double total_latency;
+
+      if (host2dev) {
+        total_time_nsec =
+            streams_size_test(size, device_buffer, host_buffer, n);
+      } else {
+        total_time_nsec =
+            streams_size_test(size, host_buffer, device_buffer, n);
+      }
+
+      calculate_metrics(total_time_nsec,
+                        static_cast<long double>(size * number_iterations),
+                        total_bandwidth, total_latency);
+      if (n == 1) {
+        single_stream_bandwidth = total_bandwidth;
+      }
+      print_results_copy_streams(direction, size, n, total_bandwidth,
+                                 total_bandwidth / single_stream_bandwidth);
+    }
+
+    buffers_release(device_buffer, host_buffer);
+  }
+}
+
+//---------------------------------------------------------------------
+// Spreads each transfer over 1 to N queues of the copy capable command
+// queue groups, to show how bandwidth scales with concurrent streams.
+//---------------------------------------------------------------------
+void ZeBandwidth::test_copy_streams(void) {
+  std::cout << std::endl;
+  std::cout << "MULTI-STREAM BANDWIDTH SCALING" << std::endl;
+
+  copy_streams_create();
+  if (copy_streams.empty()) {
+    std::cout << "No queue group with the copy flag, skipping" << std::endl;
+    return;
+  }
+
+  copy_streams_sweep("Host->Device", true);
+  copy_streams_sweep("Device->Host", false);
+
+  copy_streams_destroy();
+}
+
+static const MemoryType memory_types[] = {
+    MemoryType::HOST, MemoryType::DEVICE, MemoryType::SHARED,
+    MemoryType::SYSTEM};
+static const size_t memory_type_count =
+    sizeof(memory_types) / sizeof(memory_types[0]);
+
+static const char *memory_type_name(MemoryType type) {
+  switch (type) {
+  case MemoryType::HOST:
+    return "Host";
+  case MemoryType::DEVICE:
+    return "Device";
+  case MemoryType::SHARED:
+    return "Shared";
+  case MemoryType::SYSTEM:
+    return "System";
+  }
+  return "Unknown";
+}
+
+void *ZeBandwidth::memory_type_alloc(MemoryType type, size_t size) {
+  void *buffer = nullptr;
+
+  switch (type) {
+  case MemoryType::HOST:
+    benchmark->memoryAllocHost(size, &buffer);
+    break;
+  case MemoryType::DEVICE:
+    benchmark->memoryAlloc(size, &buffer);
+    break;
+  case MemoryType::SHARED:
+    benchmark->memoryAllocShared(size, &buffer);
+    break;
+  case MemoryType::SYSTEM:
+    buffer = malloc(size);
+    if (buffer == nullptr) {
+      throw std::runtime_error("Failed to allocate system memory");
+    }
+    break;
+  }
+  return buffer;
+}
+
+void ZeBandwidth::memory_type_free(MemoryType type, void *buffer) {
+  if (type == MemoryType::SYSTEM) {
+    free(buffer);
+  } else {
+    benchmark->memoryFree(buffer);
+  }
+}
+
+void ZeBandwidth::print_results_memory_matrix(
+    size_t buffer_size, const std::vector<long double> &bandwidth,
+    const std::vector<long double> &latency) {
+  std::cout << std::endl
+            << "Transfer size = " << buffer_size
+            << " bytes: BW in GBPS (Latency in usec)" << std::endl;
+  std::cout << std::setw(12) << "src \\ dst";
+  for (size_t dst = 0; dst < memory_type_count; dst++) {
+    std::cout << std::setw(20) << memory_type_name(memory_types[dst]);
+  }
+  std::cout << std::endl;
+
+  for (size_t src = 0; src < memory_type_count; src++) {
+    std::cout << std::setw(12) << memory_type_name(memory_types[src]);
+    for (size_t dst = 0; dst < memory_type_count; dst++) {
+      size_t cell = src * memory_type_count + dst;
+      std::cout << std::fixed << std::setw(10) << std::setprecision(3)
+                << bandwidth[cell] << " (" << std::setw(7)
+                << std::setprecision(2) << latency[cell] << ")";
+    }
+    std::cout << std::endl;
+  }
+}
+
+//---------------------------------------------------------------------
+// Measures copies from every memory type to every memory type. The
+// buffers are allocated once at the largest transfer size and written
+// before any measurement, so that neither allocation nor first touch is
+// timed.
+//---------------------------------------------------------------------
+void ZeBandwidth::test_memory_matrix(void) {
+  std::vector<void *> sources(memory_type_count);
+  std::vector<void *> destinations(memory_type_count);
+  size_t max_size = transfer_size.back();
+
+  std::cout << std::endl;
+  std::cout << "MEMORY TYPE MATRIX BANDWIDTH AND LATENCY" << std::endl;
+
+  for (size_t i = 0; i < memory_type_count; i++) {
+    sources[i] = memory_type_alloc(memory_types[i], max_size);
+    destinations[i] = memory_type_alloc(memory_types[i], max_size);
+    if (memory_types[i] == MemoryType::DEVICE) {
+      continue;
+    }
+    memset(sources[i], 0, max_size);
+    memset(destinations[i], 0, max_size);
+  }
+
+  for (auto size : transfer_size) {
+    std::vector<long double> bandwidth(memory_type_count * memory_type_count);
+    std::vector<long double> latency(memory_type_count * memory_type_count);
+
+    for (size_t src = 0; src < memory_type_count; src++) {
+      for (size_t dst = 0; dst < memory_type_count; dst++) {
+        size_t cell = src * memory_type_count + dst;
+        long double total_time_nsec;
+
+        transfer_size_test(size, destinations[dst], sources[src],
+                           total_time_nsec);
+        calculate_metrics(total_time_nsec,
+                          static_cast<long double>(size * number_iterations),
+                          bandwidth[cell], latency[cell]);
+      }
+    }
+
+    print_results_memory_matrix(size, bandwidth, latency);
+  }
+
+  for (size_t i = 0; i < memory_type_count; i++) {
+    memory_type_free(memory_types[i], sources[i]);
+    memory_type_free(memory_types[i], destinations[i]);
+  }
+}
+
+void ZeBandwidth::print_results_submission(size_t buffer_size,
+                                           const char *model,
+                                           long double latency) {
+  std::cout << "Host->Device[" << std::fixed << std::setw(10) << buffer_size
+            << "]:  " << std::left << std::setw(20) << model << std::right
+            << "Latency = " << std::setw(9) << std::setprecision(2)
+            << latency << " usec per copy" << std::endl;
+}
+
+//---------------------------------------------------------------------
+// Appends number_iterations copies to an immediate command list. A
+// synchronous list returns once the copy is done; on an asynchronous
+// list each copy signals event, which is waited on and reset.
+//---------------------------------------------------------------------
+long double
+ZeBandwidth::measure_immediate_copy(ze_command_list_handle_t immediate_list,
+                                    ze_event_handle_t event, size_t size) {
+  Timer<std::chrono::nanoseconds::period> timer;
+
+  timer.start();
+  for (uint32_t i = 0; i < number_iterations; i++) {
+    if (event == nullptr) {
+      benchmark->commandListAppendMemoryCopy(immediate_list, device_buffer,
+                                             host_buffer, size);
+    } else {
+      benchmark->commandListAppendMemoryCopy(immediate_list, device_buffer,
+                                             host_buffer, size, event);
+      benchmark->hostSynchronize(event);
+      benchmark->hostEventReset(event);
+    }
+  }
+  timer.end();
+
+  return timer.period_minus_overhead();
+}
+
+//---------------------------------------------------------------------
+// Appends copies_per_submit copies to one command list, and executes it
+// number_iterations times.
+//---------------------------------------------------------------------
+long double ZeBandwidth::measure_batched_copy(size_t size) {
+  long double total_time_nsec;
+
+  for (uint32_t i = 0; i < copies_per_submit; i++) {
+    benchmark->commandListAppendMemoryCopy(command_list, device_buffer,
+                                           host_buffer, size);
+  }
+  benchmark->commandListClose(command_list);
+
+  total_time_nsec = measure_transfer(number_iterations);
+  benchmark->commandListReset(command_list);
+
+  return total_time_nsec;
+}
+
+//---------------------------------------------------------------------
+// Compares the time per copy of a closed command list executed on a
+// queue, of synchronous and asynchronous immediate command lists, and of
+// many copies appended to one command list.
+//---------------------------------------------------------------------
+void ZeBandwidth::test_submission_latency(void) {
+  ze_command_list_handle_t immediate_sync_list;
+  ze_command_list_handle_t immediate_async_list;
+  ze_event_pool_handle_t event_pool;
+  ze_event_handle_t event;
+
+  std::cout << std::endl;
+  std::cout << "HOST-TO-DEVICE LATENCY PER COPY BY SUBMISSION MODEL"
+            << std::endl;
+
+  benchmark->commandListCreateImmediate(benchmark->device,
+                                        ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS,
+                                        &immediate_sync_list);
+  benchmark->commandListCreateImmediate(benchmark->device,
+                                        ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS,
+                                        &immediate_async_list);
+  event_pool = benchmark->create_event_pool(1, ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  benchmark->create_event(event_pool, event, 0);
+
+  for (auto size : transfer_size) {
+    long double total_time_nsec;
+    long double total_bandwidth;
+    long double total_latency;
+    std::string batched =
+        "Batched (" + std::to_string(copies_per_submit) + ")";
+
+    buffers_acquire(size, 0, &device_buffer, &host_buffer);
+
+    transfer_size_test(size, device_buffer, host_buffer, total_time_nsec);
+    calculate_metrics(total_time_nsec,
+                      static_cast<long double>(size * number_iterations),
+                      total_bandwidth, total_latency);
+    print_results_submission(size, "Queue", total_latency);
+
+    total_time_nsec =
+        measure_immediate_copy(immediate_sync_list, nullptr, size);
+    calculate_metrics(total_time_nsec,
+                      static_cast<long double>(size * number_iterations),
+                      total_bandwidth, total_latency);
+    print_results_submission(size, "Immediate sync", total_latency);
+
+    total_time_nsec = measure_immediate_copy(immediate_async_list, event, size);
+    calculate_metrics(total_time_nsec,
+                      static_cast<long double>(size * number_iterations),
+                      total_bandwidth, total_latency);
+    print_results_submission(size, "Immediate async", total_latency);
+
+    total_time_nsec = measure_batched_copy(size);
+    calculate_metrics(total_time_nsec,
+                      static_cast<long double>(size * number_iterations),
+                      total_bandwidth, total_latency);
+    print_results_submission(size, batched.c_str(),
+                             total_latency / copies_per_submit);
+
+    buffers_release(device_buffer, host_buffer);
+  }
+
+  benchmark->destroy_event(event);
+  benchmark->destroy_event_pool(event_pool);
+  benchmark->commandListDestroy(immediate_async_list);
+  benchmark->commandListDestroy(immediate_sync_list);
+}
+
+//---------------------------------------------------------------------
+// Alternates Host->Device and Device->Host transfers of size bytes for
+// one soak window, and returns the bandwidth of each direction over it.
+//---------------------------------------------------------------------
+SoakWindow ZeBandwidth::measure_soak_window(size_t size,
+                                            long double elapsed_s) {
+  Timer<std::chrono::nanoseconds::period> timer;
+  long double host2dev_time_nsec = 0.0;
+  long double dev2host_time_nsec = 0.0;
+  long double transfers = 0.0;
+  SoakWindow window;
+
+  auto window_end = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(soak_window_ms);
+  do {
+    timer.start();
+    benchmark->commandQueueExecuteCommandList(command_queue, 1, &command_list);
+    benchmark->commandQueueSynchronize(command_queue);
+    timer.end();
+    host2dev_time_nsec += timer.period_minus_overhead();
+
+    timer.start();
+    benchmark->commandQueueExecuteCommandList(command_queue, 1,
+                                              &command_list_verify);
+    benchmark->commandQueueSynchronize(command_queue);
+    timer.end();
+    dev2host_time_nsec += timer.period_minus_overhead();
+
+    transfers += 1;
+  } while (std::chrono::steady_clock::now() < window_end);
+
+  window.elapsed_s = elapsed_s;
+  window.host2dev_bandwidth = size * transfers / host2dev_time_nsec;
+  window.dev2host_bandwidth = size * transfers / dev2host_time_nsec;
+  return window;
+}
+
+static long double median_of(std::vector<long double> values) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  std::sort(values.begin(), values.end());
+  size_t middle = values.size() / 2;
+  if (values.size() % 2 == 0) {
+    return (values[middle - 1] + values[middle]) / 2;
+  }
+  return values[middle];
+}
+
+//---------------------------------------------------------------------
+// Writes the soak windows as CSV, naming in the dip column the
+// directions below soak_dip_fraction of their median bandwidth.
+//---------------------------------------------------------------------
+void ZeBandwidth::print_results_soak(std::ostream &out,
+                                     const std::vector<SoakWindow> &windows) {
+  std::vector<long double> host2dev;
+  std::vector<long double> dev2host;
+  uint32_t dips = 0;
+
+  for (auto &window : windows) {
+    host2dev.push_back(window.host2dev_bandwidth);
+    dev2host.push_back(window.dev2host_bandwidth);
+  }
+  long double host2dev_median = median_of(host2dev);
+  long double dev2host_median = median_of(dev2host);
+
+  out << "window,elapsed_s,host2dev_gbps,dev2host_gbps,dip" << std::endl;
+  for (size_t i = 0; i < windows.size(); i++) {
+    const SoakWindow &window = windows[i];
+    std::string dip;
+
+    if (window.host2dev_bandwidth < soak_dip_fraction * host2dev_median) {
+      dip = "H2D";
+    }
+    if (window.dev2host_bandwidth < soak_dip_fraction * dev2host_median) {
+      dip += dip.empty() ? "D2H" : " D2H";
+    }
+    if (!dip.empty()) {
+      dips++;
+    }
+    out << i << "," << std::fixed << std::setprecision(3) << window.elapsed_s
+        << "," << std::setprecision(6) << window.host2dev_bandwidth << ","
+        << window.dev2host_bandwidth << "," << dip << std::endl;
+  }
+
+  std::cout << "Median BW: Host->Device = " << std::fixed
+            << std::setprecision(6) << host2dev_median
+            << " GBPS  Device->Host = " << dev2host_median << " GBPS"
+            << std::endl;
+  std::cout << "Windows below " << std::setprecision(2) << soak_dip_fraction
+            << " of the median: " << dips << " of " << windows.size()
+            << std::endl;
+}
+
+//---------------------------------------------------------------------
+// Repeats the largest transfer size for soak_duration_s seconds, taking
+// one bandwidth sample per direction every soak_window_ms milliseconds.
+//---------------------------------------------------------------------
+void ZeBandwidth::test_soak(void) {
+  size_t size = transfer_size.back();
+  std::vector<SoakWindow> windows;
+
+  std::cout << std::endl;
+  std::cout << "SOAK BANDWIDTH TIME SERIES" << std::endl;
+  std::cout << "Transfer size = " << size << " bytes, " << soak_duration_s
+            << " s in windows of " << soak_window_ms << " ms" << std::endl;
+
+  buffers_acquire(size, 0, &device_buffer, &host_buffer);
+  benchmark->commandListAppendMemoryCopy(command_list, device_buffer,
+                                         host_buffer, size);
+  benchmark->commandListClose(command_list);
+  benchmark->commandListAppendMemoryCopy(command_list_verify, host_buffer,
+                                         device_buffer, size);
+  benchmark->commandListClose(command_list_verify);
+
+  auto start = std::chrono::steady_clock::now();
+  auto end = start + std::chrono::seconds(soak_duration_s);
+  do {
+    std::chrono::duration<long double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    windows.push_back(measure_soak_window(size, elapsed.count()));
+  } while (std::chrono::steady_clock::now() < end);
+
+  benchmark->commandListReset(command_list);
+  benchmark->commandListReset(command_list_verify);
+  buffers_release(device_buffer, host_buffer);
+
+  if (soak_output.empty()) {
+    print_results_soak(std::cout, windows);
+  } else {
+    std::ofstream out(soak_output);
+    if (!out) {
+      throw std::runtime_error("Failed to open " + soak_output);
+    }
+    print_results_soak(out, windows);
+    std::cout << "Time series written to " << soak_output << std::endl;
+  }
+}
+
 int main(int argc, char **argv) {
   ZeBandwidth bw;
   size_t default_size;
@@ -273,6 +1249,8 @@ int main(int argc, char **argv) {
             << "Iterations per transfer size = " << bw.number_iterations
             << std::endl;
 
+  bw.buffer_pool_create();
+
   if (bw.run_host2dev) {
     bw.test_host2device();
   }
@@ -281,6 +1259,26 @@ int main(int argc, char **argv) {
     bw.test_device2host();
   }
 
+  if (bw.run_bidirectional) {
+    bw.test_bidirectional();
+  }
+
+  if (bw.run_copy_streams) {
+    bw.test_copy_streams();
+  }
+
+  if (bw.run_memory_matrix) {
+    bw.test_memory_matrix();
+  }
+
+  if (bw.run_submission_latency) {
+    bw.test_submission_latency();
+  }
+
+  if (bw.run_soak) {
+    bw.test_soak();
+  }
+
   std::cout << std::endl;
 
   std::cout << std::flush;
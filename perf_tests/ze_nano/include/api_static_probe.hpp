@@ -13,33 +13,132 @@
 #include "hardware_counter.hpp"
 #include <level_zero/ze_api.h>
 
+#include <algorithm>
 #include <assert.h>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
 #include <iomanip>
 #include <locale>
+#include <mutex>
+#include <numeric>
 #include <string>
+#include <vector>
+#if defined(__linux__)
+#include <time.h>
+#endif
 
 const std::string PREFIX_LATENCY = "[ PERF LATENCY nS ]\t";
 const std::string PREFIX_FUNCTION_CALL_RATE = "[ PERF FUNC_CALL_RATE ]\t";
+const std::string PREFIX_FUNCTION_CALL_RATE_THREADS =
+    "[ PERF FUNC_CALL_RATE THREADS ]\t";
 const std::string PREFIX_CYCLES = "[ PERF CYCLES ]\t\t";
 const std::string PREFIX_INSTRUCTION = "[ PERF INSTRUCTIONS ]\t";
 const std::string PREFIX_IPC = "[ PERF IPC ]\t\t";
+const std::string PREFIX_CACHE_MISSES = "[ PERF CACHE MISSES ]\t";
+const std::string PREFIX_BRANCH_MISSES = "[ PERF BRANCH MISSES ]\t";
+const std::string PREFIX_CONTEXT_SWITCHES = "[ PERF CONTEXT SWITCHES ]\t";
+const std::string PREFIX_LATENCY_P50 = "[ PERF LATENCY P50 nS ]\t";
+const std::string PREFIX_LATENCY_P99 = "[ PERF LATENCY P99 nS ]\t";
+const std::string PREFIX_LATENCY_P999 = "[ PERF LATENCY P99.9 nS ]\t";
+const std::string PREFIX_LATENCY_MAX = "[ PERF LATENCY MAX nS ]\t";
+const std::string PREFIX_LATENCY_SLOWEST = "[ PERF SLOWEST CALL nS ]\t";
 
 const std::string UNIT_LATENCY = "nanoseconds";
 const std::string UNIT_FUNCTION_CALL_RATE = "function calls/sec";
 const std::string UNIT_CYCLES = "cycles";
 const std::string UNIT_INSTRUCTION = "instructions";
 const std::string UNIT_IPC = UNIT_INSTRUCTION + "/" + UNIT_CYCLES;
+const std::string UNIT_CACHE_MISSES = "cache misses";
+const std::string UNIT_BRANCH_MISSES = "branch misses";
+const std::string UNIT_CONTEXT_SWITCHES = "context switches";
+
+/* Number of slowest calls listed by the latency distribution probe */
+const int PROBE_SLOWEST_CALLS = 5;
 
 extern HardwareCounter *hardware_counters;
 void api_static_probe_init();
 void api_static_probe_cleanup();
 bool api_static_probe_is_init();
+uint64_t probe_clock_overhead_ns();
+
+/*
+ * Monotonic time in nanoseconds, read around every single call by the
+ * latency distribution probe. On Linux clock_gettime() is served by the
+ * vDSO without a system call.
+ */
+inline uint64_t probe_clock_ns() {
+#if defined(__linux__)
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000ull + now.tv_nsec;
+#else
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+#endif
+}
 
 typedef struct _probe_cofig {
   int warm_up_iteration;
   int measure_iteration;
 } probe_config_t;
 
+/* Call rate measured by one probe on one thread of a ProbeThreadGroup */
+struct ThreadCallRate {
+  std::string prefix;
+  std::string filename;
+  int line_number;
+  std::string function_name;
+  long double calls_per_second;
+};
+
+/*
+ * Runs the same test case body on several threads at once, each pinned
+ * to its own CPU where supported. Every thread creates its own handles
+ * in the body, and the threaded call rate probes of all threads measure
+ * together between two barriers, so contention in the driver shows up
+ * as a per thread call rate that drops with the number of threads.
+ */
+class ProbeThreadGroup {
+public:
+  explicit ProbeThreadGroup(int thread_count);
+  void run(const std::function<void()> &body);
+  void barrier();
+  void record(const ThreadCallRate &result);
+  static ProbeThreadGroup *current();
+
+private:
+  void print_results();
+
+  int thread_count;
+  std::mutex mutex;
+  std::condition_variable condition;
+  int waiting = 0;
+  int generation = 0;
+  /* One list of results per thread, in the order of its probes */
+  std::vector<std::vector<ThreadCallRate>> results;
+};
+
+/* Runs body on 1, 2, 4, ... threads, up to the CPUs the process may use */
+void probe_call_rate_scaling(const std::function<void()> &body);
+
+/* Keeps the measuring thread from migrating and from being preempted */
+struct ProbeIsolation {
+  /* CPU to pin the measuring thread to, -1 to leave its affinity alone */
+  int cpu = -1;
+  /* Run the measuring thread with SCHED_FIFO when permitted */
+  bool realtime = false;
+};
+
+/*
+ * Applies isolation to the calling thread and warns, without failing,
+ * when it cannot be applied or when a CPU the thread may run on is not
+ * using the performance cpufreq governor.
+ */
+void probe_isolate_current_thread(const ProbeIsolation &isolation);
+
 template <typename T>
 inline void
 print_probe_output(const std::string prefix, const std::string filename,
@@ -84,6 +183,74 @@ long double _function_call_iter_measure_latency(
   return nsec;
 }
 
+#define PROBE_MEASURE_LATENCY_DISTRIBUTION(prefix, probe_setting,           \
+                                           function_name, ...)                \
+  _function_call_latency_distribution(__FILE__, __LINE__, #function_name,     \
+                                      prefix, probe_setting, function_name,   \
+                                      __VA_ARGS__)
+/*
+ * Times every call on its own into a preallocated sample buffer, and
+ * reports the median, tail percentiles, maximum and the slowest calls
+ * with their iteration index, so that jitter hidden by the average of
+ * PROBE_MEASURE_LATENCY_ITERATION becomes visible.
+ */
+template <typename... Params, typename... Args>
+void _function_call_latency_distribution(
+    const std::string filename, const int line_number,
+    const std::string function_name, const std::string prefix,
+    const probe_config_t &probe_setting,
+    ze_result_t (*api_function)(Params... params), Args... args) {
+  int iteration_number = probe_setting.measure_iteration;
+
+  if (iteration_number <= 0) {
+    return;
+  }
+
+  std::vector<uint64_t> samples(iteration_number);
+  uint64_t overhead = probe_clock_overhead_ns();
+
+  for (int i = 0; i < iteration_number; i++) {
+    uint64_t call_start = probe_clock_ns();
+    api_function(args...);
+    uint64_t call_end = probe_clock_ns();
+    samples[i] = call_end - call_start;
+  }
+
+  for (auto &sample : samples) {
+    sample = (sample > overhead) ? sample - overhead : 0;
+  }
+
+  std::vector<uint64_t> sorted(samples);
+  std::sort(sorted.begin(), sorted.end());
+  auto percentile = [&sorted](long double fraction) {
+    size_t rank = static_cast<size_t>(fraction * sorted.size());
+    return sorted[std::min(rank, sorted.size() - 1)];
+  };
+
+  print_probe_output(PREFIX_LATENCY_P50 + prefix, filename, line_number,
+                     function_name, percentile(0.5), UNIT_LATENCY);
+  print_probe_output(PREFIX_LATENCY_P99 + prefix, filename, line_number,
+                     function_name, percentile(0.99), UNIT_LATENCY);
+  print_probe_output(PREFIX_LATENCY_P999 + prefix, filename, line_number,
+                     function_name, percentile(0.999), UNIT_LATENCY);
+  print_probe_output(PREFIX_LATENCY_MAX + prefix, filename, line_number,
+                     function_name, sorted.back(), UNIT_LATENCY);
+
+  int slowest_count = std::min(PROBE_SLOWEST_CALLS, iteration_number);
+  std::vector<int> slowest(iteration_number);
+  std::iota(slowest.begin(), slowest.end(), 0);
+  std::partial_sort(slowest.begin(), slowest.begin() + slowest_count,
+                    slowest.end(), [&samples](int a, int b) {
+                      return samples[a] > samples[b];
+                    });
+  for (int i = 0; i < slowest_count; i++) {
+    print_probe_output(PREFIX_LATENCY_SLOWEST + prefix, filename, line_number,
+                       function_name, samples[slowest[i]],
+                       UNIT_LATENCY + " at iteration " +
+                           std::to_string(slowest[i]));
+  }
+}
+
 #define PROBE_MEASURE_HARDWARE_COUNTERS(prefix, probe_setting, function_name,  \
                                         ...)                                   \
   _function_call_iter_hardware_counters(__FILE__, __LINE__, #function_name,    \
@@ -118,6 +285,14 @@ void _function_call_iter_hardware_counters(
   }
   hardware_counters->end();
 
+  /* A backend can find out only now that it cannot count */
+  if (hardware_counters->is_supported() == false) {
+    print_probe_output(UNIT_CYCLES + prefix, filename, line_number,
+                       function_name, HardwareCounter::support_warning(),
+                       "");
+    return;
+  }
+
   auto total_instruction_count = hardware_counters->counter_instructions();
   auto total_cycle_count = hardware_counters->counter_cycles();
 
@@ -135,6 +310,29 @@ void _function_call_iter_hardware_counters(
                      function_name, normalized_cycle_count, UNIT_CYCLES);
   print_probe_output(PREFIX_IPC + prefix, filename, line_number, function_name,
                      instruction_per_cycle, UNIT_IPC);
+
+  /* Optional counters, not available with every backend and CPU */
+  const struct {
+    long long total;
+    const std::string &prefix;
+    const std::string &unit;
+  } optional_counters[] = {
+      {hardware_counters->counter_cache_misses(), PREFIX_CACHE_MISSES,
+       UNIT_CACHE_MISSES},
+      {hardware_counters->counter_branch_misses(), PREFIX_BRANCH_MISSES,
+       UNIT_BRANCH_MISSES},
+      {hardware_counters->counter_context_switches(), PREFIX_CONTEXT_SWITCHES,
+       UNIT_CONTEXT_SWITCHES},
+  };
+  for (auto &counter : optional_counters) {
+    if (counter.total < 0) {
+      continue;
+    }
+    print_probe_output(counter.prefix + prefix, filename, line_number,
+                       function_name,
+                       static_cast<double>(counter.total) / iteration_number,
+                       counter.unit);
+  }
 }
 
 #define PROBE_MEASURE_FUNCTION_CALL_RATE(prefix, probe_setting, function_name, \
@@ -189,4 +387,45 @@ void _function_call_rate_iter(const std::string filename, const int line_number,
                      function_name, function_call_counter,
                      UNIT_FUNCTION_CALL_RATE);
 }
+
+#define PROBE_MEASURE_FUNCTION_CALL_RATE_THREADS(prefix, probe_setting,      \
+                                                 function_name, ...)         \
+  _function_call_rate_threads(__FILE__, __LINE__, #function_name, prefix,     \
+                              function_name, __VA_ARGS__)
+/*
+ * Counts the calls made by this thread of the current ProbeThreadGroup
+ * while all of its threads call their api function for the same period.
+ * The time is only read every batch of calls, to keep it out of the
+ * measured rate.
+ */
+template <typename... Params, typename... Args>
+void _function_call_rate_threads(const std::string filename,
+                                 const int line_number,
+                                 const std::string function_name,
+                                 const std::string prefix,
+                                 ze_result_t (*api_function)(Params... params),
+                                 Args... args) {
+  ProbeThreadGroup *group = ProbeThreadGroup::current();
+  Timer<> timer;
+  const long double period = 250000000.0; /* 250 ms in nanoseconds */
+  const int calls_per_check = 64;
+  long long function_call_counter = 0;
+
+  assert(group != nullptr);
+
+  group->barrier();
+  timer.start();
+  while (timer.has_it_been(period) == false) {
+    for (int i = 0; i < calls_per_check; i++) {
+      api_function(args...);
+    }
+    function_call_counter += calls_per_check;
+  }
+  timer.end();
+
+  group->record({prefix, filename, line_number, function_name,
+                 function_call_counter * 1000000000.0 /
+                     timer.period_minus_overhead()});
+  group->barrier();
+}
 #endif /* _API_STATIC_PROBE_HPP_ */
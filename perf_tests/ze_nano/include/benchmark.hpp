@@ -18,19 +18,44 @@ inline void cleanup() { api_static_probe_cleanup(); }
 
 namespace latency {
 #include "benchmark_template/command_list.hpp"
+#include "benchmark_template/event.hpp"
+#include "benchmark_template/fence.hpp"
 #include "benchmark_template/ipc.hpp"
+#include "benchmark_template/memory.hpp"
 #include "benchmark_template/set_parameter.hpp"
 } /* namespace latency */
+namespace latency_distribution {
+#include "benchmark_template/command_list.hpp"
+#include "benchmark_template/event.hpp"
+#include "benchmark_template/fence.hpp"
+#include "benchmark_template/ipc.hpp"
+#include "benchmark_template/memory.hpp"
+#include "benchmark_template/set_parameter.hpp"
+} /* namespace latency_distribution */
 namespace hardware_counter {
 #include "benchmark_template/command_list.hpp"
+#include "benchmark_template/event.hpp"
+#include "benchmark_template/fence.hpp"
 #include "benchmark_template/ipc.hpp"
+#include "benchmark_template/memory.hpp"
 #include "benchmark_template/set_parameter.hpp"
 } /* namespace hardware_counter */
 namespace fuction_call_rate {
 #include "benchmark_template/command_list.hpp"
+#include "benchmark_template/event.hpp"
+#include "benchmark_template/fence.hpp"
 #include "benchmark_template/ipc.hpp"
+#include "benchmark_template/memory.hpp"
 #include "benchmark_template/set_parameter.hpp"
 } /* namespace fuction_call_rate */
+namespace function_call_rate_threads {
+#include "benchmark_template/command_list.hpp"
+#include "benchmark_template/event.hpp"
+#include "benchmark_template/fence.hpp"
+#include "benchmark_template/ipc.hpp"
+#include "benchmark_template/memory.hpp"
+#include "benchmark_template/set_parameter.hpp"
+} /* namespace function_call_rate_threads */
 } /* namespace ze_api_benchmarks */
 
 #endif /* _BENCHMARK_HPP_ */
@@ -10,3 +10,4 @@ void launch_function_no_parameter(ZeApp *benchmark,
                                   probe_config_t &probe_setting);
 void command_list_empty_execute(ZeApp *benchmark,
                                 probe_config_t &probe_setting);
+void command_list_reset(ZeApp *benchmark, probe_config_t &probe_setting);
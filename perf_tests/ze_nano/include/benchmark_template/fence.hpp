@@ -0,0 +1,9 @@
+/*
+ *
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+void fence_query_status(ZeApp *benchmark, probe_config_t &probe_setting);
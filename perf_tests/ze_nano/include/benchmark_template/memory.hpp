@@ -0,0 +1,12 @@
+/*
+ *
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+void memory_alloc_free(ZeApp *benchmark, probe_config_t &probe_setting);
+void memory_get_alloc_properties(ZeApp *benchmark,
+                                 probe_config_t &probe_setting);
+void memory_copy_append(ZeApp *benchmark, probe_config_t &probe_setting);
@@ -9,3 +9,4 @@
 void parameter_integer(ZeApp *benchmark, probe_config_t &probe_setting);
 void parameter_buffer(ZeApp *benchmark, probe_config_t &probe_setting);
 void parameter_image(ZeApp *benchmark, probe_config_t &probe_setting);
+void kernel_group_size(ZeApp *benchmark, probe_config_t &probe_setting);
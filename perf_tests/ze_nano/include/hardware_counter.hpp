@@ -8,6 +8,7 @@
 
 #ifndef _HARDWARE_COUNTER_HPP_
 #define _HARDWARE_COUNTER_HPP_
+#include <cstdint>
 #include <iostream>
 
 class HardwareCounter {
@@ -18,6 +19,10 @@ public:
   void end(void);
   long long counter_instructions(void);
   long long counter_cycles(void);
+  /* -1 when the counter is not available */
+  long long counter_cache_misses(void);
+  long long counter_branch_misses(void);
+  long long counter_context_switches(void);
   bool is_supported(void);
   static std::string support_warning(void);
 
@@ -42,6 +47,17 @@ private:
   bool active_period;
 
   long long values[number_events];
+#elif defined(WITH_PERF_EVENT)
+  /* Instructions, cycles, cache misses, branch misses, context switches */
+  static const unsigned int number_perf_events = 5;
+  bool _counter_enabled;
+  bool measurement_taken;
+  bool active_period;
+
+  /* One perf_event group, fds[0] leads; -1 for counters failing to open */
+  int fds[number_perf_events];
+  uint64_t ids[number_perf_events];
+  long long values[number_perf_events];
 #endif
 };
 
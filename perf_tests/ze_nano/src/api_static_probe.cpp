@@ -8,6 +8,15 @@
 
 #include "api_static_probe.hpp"
 
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 HardwareCounter *hardware_counters = NULL;
 static bool static_probe_init = false;
 
@@ -25,3 +34,254 @@ void api_static_probe_cleanup() {
 }
 
 bool api_static_probe_is_init() { return static_probe_init; }
+
+/*
+ * Median cost of reading the probe clock twice back to back, subtracted
+ * from every sample of the latency distribution probe. It is measured
+ * once per process.
+ */
+uint64_t probe_clock_overhead_ns() {
+  static uint64_t overhead = [] {
+    const int samples_count = 1001;
+    std::vector<uint64_t> samples(samples_count);
+
+    for (int i = 0; i < samples_count; i++) {
+      uint64_t start = probe_clock_ns();
+      uint64_t end = probe_clock_ns();
+      samples[i] = end - start;
+    }
+    std::nth_element(samples.begin(), samples.begin() + samples_count / 2,
+                     samples.end());
+    return samples[samples_count / 2];
+  }();
+  return overhead;
+}
+
+static thread_local ProbeThreadGroup *current_thread_group = nullptr;
+static thread_local int current_thread_index = 0;
+
+ProbeThreadGroup::ProbeThreadGroup(int thread_count)
+    : thread_count(thread_count), results(thread_count) {}
+
+ProbeThreadGroup *ProbeThreadGroup::current() { return current_thread_group; }
+
+/*
+ * CPUs the process may run on, from its affinity mask as set by taskset
+ * or a cgroup. It is read once, before --cpu narrows the measuring
+ * thread down to a single CPU. Empty where affinity is not supported.
+ */
+static const std::vector<int> &allowed_cpus() {
+  static const std::vector<int> cpus = [] {
+    std::vector<int> list;
+#if defined(__linux__)
+    cpu_set_t cpu_set;
+    if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) == 0) {
+      for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+        if (CPU_ISSET(cpu, &cpu_set)) {
+          list.push_back(cpu);
+        }
+      }
+    }
+#endif
+    return list;
+  }();
+  return cpus;
+}
+
+/*
+ * Pins the calling thread to the index-th allowed CPU, and runs it with
+ * the normal scheduling policy: threads started from a measuring thread
+ * raised to SCHED_FIFO inherit it, and busy-looping real time threads on
+ * every CPU would starve the rest of the system and the driver's own
+ * threads, which would distort the contention being measured.
+ */
+static void pin_current_thread(int index) {
+#if defined(__linux__)
+  const std::vector<int> &cpus = allowed_cpus();
+  cpu_set_t cpu_set;
+  struct sched_param param = {};
+
+  if (sched_getscheduler(0) != SCHED_OTHER) {
+    validate<false>(pthread_setschedparam(pthread_self(), SCHED_OTHER, &param),
+                    "pthread_setschedparam");
+  }
+  if (cpus.empty()) {
+    return;
+  }
+  CPU_ZERO(&cpu_set);
+  CPU_SET(cpus[index % cpus.size()], &cpu_set);
+  validate<false>(
+      pthread_setaffinity_np(pthread_self(), sizeof(cpu_set), &cpu_set),
+      "pthread_setaffinity_np");
+#else
+  (void)index;
+#endif
+}
+
+void ProbeThreadGroup::run(const std::function<void()> &body) {
+  std::vector<std::thread> threads;
+
+  for (int i = 0; i < thread_count; i++) {
+    threads.emplace_back([this, i, &body] {
+      pin_current_thread(i);
+      current_thread_group = this;
+      current_thread_index = i;
+      body();
+      current_thread_group = nullptr;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  print_results();
+}
+
+void ProbeThreadGroup::barrier() {
+  std::unique_lock<std::mutex> lock(mutex);
+  int arrival_generation = generation;
+
+  if (++waiting == thread_count) {
+    waiting = 0;
+    generation++;
+    condition.notify_all();
+    return;
+  }
+  condition.wait(lock, [this, arrival_generation] {
+    return generation != arrival_generation;
+  });
+}
+
+void ProbeThreadGroup::record(const ThreadCallRate &result) {
+  /* Each thread only appends to its own list */
+  results[current_thread_index].push_back(result);
+}
+
+void ProbeThreadGroup::print_results() {
+  for (size_t probe = 0; probe < results[0].size(); probe++) {
+    const ThreadCallRate &first = results[0][probe];
+    long double aggregate = 0;
+    long double slowest = first.calls_per_second;
+    long double fastest = first.calls_per_second;
+
+    for (auto &thread_results : results) {
+      long double rate = thread_results[probe].calls_per_second;
+      aggregate += rate;
+      slowest = std::min(slowest, rate);
+      fastest = std::max(fastest, rate);
+    }
+
+    std::string prefix = PREFIX_FUNCTION_CALL_RATE_THREADS + first.prefix +
+                         std::to_string(thread_count) + " threads ";
+    print_probe_output(prefix + "aggregate\t", first.filename,
+                       first.line_number, first.function_name,
+                       static_cast<long long>(aggregate),
+                       UNIT_FUNCTION_CALL_RATE);
+    print_probe_output(prefix + "per thread\t", first.filename,
+                       first.line_number, first.function_name,
+                       static_cast<long long>(aggregate / thread_count),
+                       UNIT_FUNCTION_CALL_RATE);
+    print_probe_output(prefix + "slowest thread\t", first.filename,
+                       first.line_number, first.function_name,
+                       static_cast<long long>(slowest),
+                       UNIT_FUNCTION_CALL_RATE);
+    print_probe_output(prefix + "fastest thread\t", first.filename,
+                       first.line_number, first.function_name,
+                       static_cast<long long>(fastest),
+                       UNIT_FUNCTION_CALL_RATE);
+  }
+}
+
+void probe_call_rate_scaling(const std::function<void()> &body) {
+  int max_threads = static_cast<int>(allowed_cpus().size());
+
+  if (max_threads < 1) {
+    max_threads =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+  }
+  for (int thread_count = 1;; thread_count *= 2) {
+    thread_count = std::min(thread_count, max_threads);
+    ProbeThreadGroup group(thread_count);
+    group.run(body);
+    if (thread_count == max_threads) {
+      break;
+    }
+  }
+}
+
+#if defined(__linux__)
+static void check_cpu_governor() {
+  cpu_set_t cpu_set;
+  int slow_cpu = -1;
+  int slow_cpu_count = 0;
+  std::string slow_governor;
+
+  if (sched_getaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+    return;
+  }
+  for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+    if (!CPU_ISSET(cpu, &cpu_set)) {
+      continue;
+    }
+    /* Not every system exposes cpufreq, for example virtual machines */
+    std::ifstream file("/sys/devices/system/cpu/cpu" + std::to_string(cpu) +
+                       "/cpufreq/scaling_governor");
+    std::string governor;
+    if (!(file >> governor) || governor == "performance") {
+      continue;
+    }
+    if (slow_cpu_count++ == 0) {
+      slow_cpu = cpu;
+      slow_governor = governor;
+    }
+  }
+
+  if (slow_cpu_count > 0) {
+    std::cerr << "WARNING : " << slow_cpu_count
+              << " CPU(s) the measuring thread may run on are not using the "
+                 "performance cpufreq governor (CPU "
+              << slow_cpu << " uses " << slow_governor
+              << "), results may vary with the clock frequency" << std::endl;
+  }
+}
+#endif
+
+void probe_isolate_current_thread(const ProbeIsolation &isolation) {
+  /* Record the CPUs of the process before pinning this thread to one */
+  allowed_cpus();
+
+#if defined(__linux__)
+  if (isolation.cpu >= CPU_SETSIZE) {
+    std::cerr << "WARNING : cannot pin the measuring thread to CPU "
+              << isolation.cpu << " : CPU out of range" << std::endl;
+  } else if (isolation.cpu >= 0) {
+    cpu_set_t cpu_set;
+    CPU_ZERO(&cpu_set);
+    CPU_SET(isolation.cpu, &cpu_set);
+    if (sched_setaffinity(0, sizeof(cpu_set), &cpu_set) != 0) {
+      std::cerr << "WARNING : cannot pin the measuring thread to CPU "
+                << isolation.cpu << " : " << std::strerror(errno)
+                << std::endl;
+    }
+  }
+
+  if (isolation.realtime) {
+    struct sched_param param = {};
+    /* The lowest real time priority is enough to preempt normal tasks */
+    param.sched_priority = sched_get_priority_min(SCHED_FIFO);
+    if (sched_setscheduler(0, SCHED_FIFO, &param) != 0) {
+      std::cerr << "WARNING : cannot run the measuring thread with "
+                   "SCHED_FIFO, it needs CAP_SYS_NICE or an RLIMIT_RTPRIO : "
+                << std::strerror(errno) << std::endl;
+    }
+  }
+
+  check_cpu_governor();
+#else
+  if (isolation.cpu >= 0 || isolation.realtime) {
+    std::cerr << "WARNING : CPU pinning and SCHED_FIFO are only supported "
+                 "on Linux"
+              << std::endl;
+  }
+#endif
+}
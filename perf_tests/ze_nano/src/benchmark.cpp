@@ -24,6 +24,9 @@
 
 #include "api_static_probe.hpp"
 
+#include <algorithm>
+#include <string>
+
 namespace ze_api_benchmarks {
 /*
  * For each test case created, the NANO_PROBE macro needs to be redefined to
@@ -33,15 +36,32 @@ namespace ze_api_benchmarks {
 #define NANO_PROBE PROBE_MEASURE_LATENCY_ITERATION
 namespace latency {
 #include "benchmark_template/command_list.cpp"
+#include "benchmark_template/event.cpp"
+#include "benchmark_template/fence.cpp"
 #include "benchmark_template/ipc.cpp"
+#include "benchmark_template/memory.cpp"
 #include "benchmark_template/set_parameter.cpp"
 } /* namespace latency */
 
+#undef NANO_PROBE
+#define NANO_PROBE PROBE_MEASURE_LATENCY_DISTRIBUTION
+namespace latency_distribution {
+#include "benchmark_template/command_list.cpp"
+#include "benchmark_template/event.cpp"
+#include "benchmark_template/fence.cpp"
+#include "benchmark_template/ipc.cpp"
+#include "benchmark_template/memory.cpp"
+#include "benchmark_template/set_parameter.cpp"
+} /* namespace latency_distribution */
+
 #undef NANO_PROBE
 #define NANO_PROBE PROBE_MEASURE_HARDWARE_COUNTERS
 namespace hardware_counter {
 #include "benchmark_template/command_list.cpp"
+#include "benchmark_template/event.cpp"
+#include "benchmark_template/fence.cpp"
 #include "benchmark_template/ipc.cpp"
+#include "benchmark_template/memory.cpp"
 #include "benchmark_template/set_parameter.cpp"
 } /* namespace hardware_counter */
 
@@ -49,7 +69,21 @@ namespace hardware_counter {
 #define NANO_PROBE PROBE_MEASURE_FUNCTION_CALL_RATE
 namespace fuction_call_rate {
 #include "benchmark_template/command_list.cpp"
+#include "benchmark_template/event.cpp"
+#include "benchmark_template/fence.cpp"
 #include "benchmark_template/ipc.cpp"
+#include "benchmark_template/memory.cpp"
 #include "benchmark_template/set_parameter.cpp"
 } /* namespace fuction_call_rate */
+
+#undef NANO_PROBE
+#define NANO_PROBE PROBE_MEASURE_FUNCTION_CALL_RATE_THREADS
+namespace function_call_rate_threads {
+#include "benchmark_template/command_list.cpp"
+#include "benchmark_template/event.cpp"
+#include "benchmark_template/fence.cpp"
+#include "benchmark_template/ipc.cpp"
+#include "benchmark_template/memory.cpp"
+#include "benchmark_template/set_parameter.cpp"
+} /* namespace function_call_rate_threads */
 } /* namespace ze_api_benchmarks */
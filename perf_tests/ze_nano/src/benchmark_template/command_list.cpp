@@ -55,3 +55,18 @@ void command_list_empty_execute(ZeApp *benchmark,
   benchmark->commandListDestroy(command_list);
   benchmark->commandQueueDestroy(command_queue);
 }
+
+void command_list_reset(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_command_list_handle_t command_list;
+  benchmark->commandListCreate(&command_list);
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    zeCommandListReset(command_list);
+  }
+
+  NANO_PROBE(" Empty command list\t", probe_setting, zeCommandListReset,
+             command_list);
+
+  benchmark->commandListDestroy(command_list);
+}
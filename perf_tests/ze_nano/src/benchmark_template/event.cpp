@@ -0,0 +1,100 @@
+/*
+ *
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+/*
+ * If function signatures are updated, benchmark_template/event.hpp
+ * needs to be updated.
+ */
+
+/* An event is created and destroyed in pairs, so they are probed together */
+static ze_result_t event_create_and_destroy(ze_event_pool_handle_t event_pool,
+                                            const ze_event_desc_t *event_desc) {
+  ze_event_handle_t event;
+  ze_result_t result = zeEventCreate(event_pool, event_desc, &event);
+  if (result != ZE_RESULT_SUCCESS) {
+    return result;
+  }
+  return zeEventDestroy(event);
+}
+
+void event_create_destroy(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_event_pool_handle_t event_pool;
+  ze_event_desc_t event_desc = {};
+  event_desc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+  event_desc.index = 0;
+
+  event_pool = benchmark->create_event_pool(1, ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    event_create_and_destroy(event_pool, &event_desc);
+  }
+
+  NANO_PROBE(" Event create and destroy\t", probe_setting,
+             event_create_and_destroy, event_pool, &event_desc);
+
+  benchmark->destroy_event_pool(event_pool);
+}
+
+void event_host_signal(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_event_pool_handle_t event_pool;
+  ze_event_handle_t event;
+
+  event_pool = benchmark->create_event_pool(1, ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  benchmark->create_event(event_pool, event, 0);
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    zeEventHostSignal(event);
+  }
+
+  NANO_PROBE(" Event host signal\t", probe_setting, zeEventHostSignal, event);
+
+  benchmark->destroy_event(event);
+  benchmark->destroy_event_pool(event_pool);
+}
+
+void event_query_status(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_event_pool_handle_t event_pool;
+  ze_event_handle_t event;
+
+  event_pool = benchmark->create_event_pool(1, ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  benchmark->create_event(event_pool, event, 0);
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    zeEventQueryStatus(event);
+  }
+
+  NANO_PROBE(" Event not signaled\t", probe_setting, zeEventQueryStatus,
+             event);
+
+  SUCCESS_OR_TERMINATE(zeEventHostSignal(event));
+  NANO_PROBE(" Event signaled\t", probe_setting, zeEventQueryStatus, event);
+
+  benchmark->destroy_event(event);
+  benchmark->destroy_event_pool(event_pool);
+}
+
+void event_host_reset(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_event_pool_handle_t event_pool;
+  ze_event_handle_t event;
+
+  event_pool = benchmark->create_event_pool(1, ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  benchmark->create_event(event_pool, event, 0);
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    zeEventHostReset(event);
+  }
+
+  NANO_PROBE(" Event host reset\t", probe_setting, zeEventHostReset, event);
+
+  benchmark->destroy_event(event);
+  benchmark->destroy_event_pool(event_pool);
+}
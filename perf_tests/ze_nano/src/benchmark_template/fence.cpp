@@ -0,0 +1,33 @@
+/*
+ *
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+/*
+ * If function signatures are updated, benchmark_template/fence.hpp
+ * needs to be updated.
+ */
+void fence_query_status(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_command_queue_handle_t command_queue;
+  ze_fence_handle_t fence;
+  ze_fence_desc_t fence_desc = {};
+  fence_desc.stype = ZE_STRUCTURE_TYPE_FENCE_DESC;
+
+  benchmark->commandQueueCreate(0, /*command_queue_id */
+                                &command_queue);
+  SUCCESS_OR_TERMINATE(zeFenceCreate(command_queue, &fence_desc, &fence));
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    zeFenceQueryStatus(fence);
+  }
+
+  NANO_PROBE(" Fence not signaled\t", probe_setting, zeFenceQueryStatus,
+             fence);
+
+  SUCCESS_OR_TERMINATE(zeFenceDestroy(fence));
+  benchmark->commandQueueDestroy(command_queue);
+}
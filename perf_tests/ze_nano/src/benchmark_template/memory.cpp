@@ -0,0 +1,141 @@
+/*
+ *
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+/*
+ * If function signatures are updated, benchmark_template/memory.hpp
+ * needs to be updated.
+ */
+
+/* Sizes probed by the allocation and copy test cases */
+static const size_t memory_size_classes[] = {64, 4 * 1024, 64 * 1024,
+                                             2 * 1024 * 1024};
+
+static std::string size_class_prefix(const std::string &name, size_t size) {
+  return " " + name + " " + std::to_string(size) + " bytes\t";
+}
+
+/* Memory is allocated and freed in pairs, so they are probed together */
+static ze_result_t
+memory_alloc_host_and_free(ze_context_handle_t context,
+                           const ze_host_mem_alloc_desc_t *host_desc,
+                           size_t size) {
+  void *buffer;
+  ze_result_t result = zeMemAllocHost(context, host_desc, size, 1, &buffer);
+  if (result != ZE_RESULT_SUCCESS) {
+    return result;
+  }
+  return zeMemFree(context, buffer);
+}
+
+static ze_result_t
+memory_alloc_device_and_free(ze_context_handle_t context,
+                             const ze_device_mem_alloc_desc_t *device_desc,
+                             size_t size, ze_device_handle_t device) {
+  void *buffer;
+  ze_result_t result =
+      zeMemAllocDevice(context, device_desc, size, 1, device, &buffer);
+  if (result != ZE_RESULT_SUCCESS) {
+    return result;
+  }
+  return zeMemFree(context, buffer);
+}
+
+static ze_result_t
+memory_alloc_shared_and_free(ze_context_handle_t context,
+                             const ze_device_mem_alloc_desc_t *device_desc,
+                             const ze_host_mem_alloc_desc_t *host_desc,
+                             size_t size, ze_device_handle_t device) {
+  void *buffer;
+  ze_result_t result = zeMemAllocShared(context, device_desc, host_desc, size,
+                                        1, device, &buffer);
+  if (result != ZE_RESULT_SUCCESS) {
+    return result;
+  }
+  return zeMemFree(context, buffer);
+}
+
+void memory_alloc_free(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_host_mem_alloc_desc_t host_desc = {};
+  host_desc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+  ze_device_mem_alloc_desc_t device_desc = {};
+  device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+  for (auto size : memory_size_classes) {
+    /* Warm up */
+    for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+      memory_alloc_host_and_free(benchmark->context, &host_desc, size);
+      memory_alloc_device_and_free(benchmark->context, &device_desc, size,
+                                   benchmark->device);
+      memory_alloc_shared_and_free(benchmark->context, &device_desc,
+                                   &host_desc, size, benchmark->device);
+    }
+
+    NANO_PROBE(size_class_prefix("Host", size), probe_setting,
+               memory_alloc_host_and_free, benchmark->context, &host_desc,
+               size);
+    NANO_PROBE(size_class_prefix("Device", size), probe_setting,
+               memory_alloc_device_and_free, benchmark->context, &device_desc,
+               size, benchmark->device);
+    NANO_PROBE(size_class_prefix("Shared", size), probe_setting,
+               memory_alloc_shared_and_free, benchmark->context, &device_desc,
+               &host_desc, size, benchmark->device);
+  }
+}
+
+void memory_get_alloc_properties(ZeApp *benchmark,
+                                 probe_config_t &probe_setting) {
+  void *buffer;
+  ze_memory_allocation_properties_t properties = {};
+  properties.stype = ZE_STRUCTURE_TYPE_MEMORY_ALLOCATION_PROPERTIES;
+  ze_device_handle_t device;
+
+  benchmark->memoryAlloc(sizeof(uint8_t), &buffer);
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    zeMemGetAllocProperties(benchmark->context, buffer, &properties, &device);
+  }
+
+  NANO_PROBE(" Device memory\t", probe_setting, zeMemGetAllocProperties,
+             benchmark->context, buffer, &properties, &device);
+
+  benchmark->memoryFree(buffer);
+}
+
+void memory_copy_append(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_command_list_handle_t command_list;
+  void *device_buffer;
+  void *host_buffer;
+  size_t max_size = memory_size_classes[0];
+
+  for (auto size : memory_size_classes) {
+    max_size = std::max(max_size, size);
+  }
+  benchmark->memoryAlloc(max_size, &device_buffer);
+  benchmark->memoryAllocHost(max_size, &host_buffer);
+  benchmark->commandListCreate(&command_list);
+
+  for (auto size : memory_size_classes) {
+    /* Warm up */
+    for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+      zeCommandListAppendMemoryCopy(command_list, device_buffer, host_buffer,
+                                    size, nullptr, 0, nullptr);
+    }
+
+    NANO_PROBE(size_class_prefix("Host to device", size), probe_setting,
+               zeCommandListAppendMemoryCopy, command_list, device_buffer,
+               host_buffer, size, nullptr, 0, nullptr);
+
+    /* Start every size class with an empty command list */
+    benchmark->commandListReset(command_list);
+  }
+
+  benchmark->commandListDestroy(command_list);
+  benchmark->memoryFree(host_buffer);
+  benchmark->memoryFree(device_buffer);
+}
@@ -107,3 +107,22 @@ void parameter_image(ZeApp *benchmark, probe_config_t &probe_setting) {
 
   benchmark->functionDestroy(function);
 }
+
+void kernel_group_size(ZeApp *benchmark, probe_config_t &probe_setting) {
+  ze_kernel_handle_t function;
+
+  benchmark->functionCreate(&function, "function_no_parameter");
+
+  /* Warm up */
+  for (int i = 0; i < probe_setting.warm_up_iteration; i++) {
+    zeKernelSetGroupSize(function, 1, 1, 1);
+  }
+
+  NANO_PROBE(" Group size 1x1x1\t", probe_setting, zeKernelSetGroupSize,
+             function, 1, 1, 1);
+
+  NANO_PROBE(" Group size 64x1x1\t", probe_setting, zeKernelSetGroupSize,
+             function, 64, 1, 1);
+
+  benchmark->functionDestroy(function);
+}
@@ -0,0 +1,237 @@
+/*
+ *
+ * Copyright (C) 2019 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "common.hpp"
+#include "hardware_counter.hpp"
+
+#include <assert.h>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+/* Events in the order of the file descriptors, the group leader first */
+static const struct {
+  uint32_t type;
+  uint64_t config;
+  const char *name;
+} perf_events[] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "cache misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch misses"},
+    {PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES, "context switches"},
+};
+
+/* Required counter that failed to open and its errno, for the warning */
+static const char *open_failed_event = nullptr;
+static int open_failed_errno = 0;
+/* Set when the PMU never scheduled the group during a measurement */
+static bool group_never_scheduled = false;
+
+static int perf_event_open(struct perf_event_attr *attr, int group_fd) {
+  return static_cast<int>(
+      syscall(__NR_perf_event_open, attr, 0 /* this thread */,
+              -1 /* any cpu */, group_fd, 0 /* flags */));
+}
+
+static int open_event(unsigned int event, int group_fd, bool exclude_kernel) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = perf_events[event].type;
+  attr.config = perf_events[event].config;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                     PERF_FORMAT_TOTAL_TIME_ENABLED |
+                     PERF_FORMAT_TOTAL_TIME_RUNNING;
+  attr.disabled = (group_fd == -1) ? 1 : 0;
+  attr.exclude_kernel = exclude_kernel ? 1 : 0;
+  attr.exclude_hv = 1;
+  return perf_event_open(&attr, group_fd);
+}
+
+HardwareCounter::HardwareCounter() {
+  measurement_taken = false;
+  active_period = false;
+  _counter_enabled = false;
+  for (unsigned int i = 0; i < number_perf_events; i++) {
+    fds[i] = -1;
+    ids[i] = 0;
+    values[i] = -1;
+  }
+
+  /*
+   * Count the kernel part of the driver's host path when allowed, and
+   * only the user part when perf_event_paranoid forbids kernel counting.
+   */
+  bool exclude_kernel = false;
+  fds[0] = open_event(0, -1, exclude_kernel);
+  if (fds[0] == -1) {
+    exclude_kernel = true;
+    fds[0] = open_event(0, -1, exclude_kernel);
+  }
+  if (fds[0] == -1) {
+    open_failed_event = perf_events[0].name;
+    open_failed_errno = errno;
+    return;
+  }
+
+  for (unsigned int i = 1; i < number_perf_events; i++) {
+    fds[i] = open_event(i, fds[0], exclude_kernel);
+    if ((fds[i] == -1) && (i == 1)) {
+      open_failed_event = perf_events[i].name;
+      open_failed_errno = errno;
+    }
+    if ((fds[i] == -1) && verbose) {
+      std::cout << "perf_event " << perf_events[i].name
+                << " counter is not available" << std::endl;
+    }
+  }
+
+  for (unsigned int i = 0; i < number_perf_events; i++) {
+    if (fds[i] != -1) {
+      SUCCESS_OR_TERMINATE(ioctl(fds[i], PERF_EVENT_IOC_ID, &ids[i]));
+    }
+  }
+
+  /* Instructions and cycles are required, the other counters optional */
+  _counter_enabled = (fds[1] != -1);
+}
+
+HardwareCounter::~HardwareCounter() {
+  for (unsigned int i = number_perf_events; i > 0; i--) {
+    if (fds[i - 1] != -1) {
+      close(fds[i - 1]);
+    }
+  }
+}
+
+void HardwareCounter::start(void) {
+  assert(_counter_enabled);
+  measurement_taken = true;
+  active_period = true;
+  SUCCESS_OR_TERMINATE(
+      ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP));
+  SUCCESS_OR_TERMINATE(
+      ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP));
+}
+
+//---------------------------------------------------------------------
+// Stops the group and reads all of its counters at once. The group read
+// returns the number of counters, the time the group was enabled and the
+// time it was running on the PMU, followed by a value and id pair for
+// each counter. When the PMU could not keep the group scheduled, for
+// example because the NMI watchdog or another perf user holds a counter,
+// the values are scaled up to the enabled time. A group that never ran
+// disables the counters, as its values are all zero.
+//---------------------------------------------------------------------
+void HardwareCounter::end(void) {
+  uint64_t buffer[3 + 2 * number_perf_events];
+  static bool multiplexing_reported = false;
+
+  SUCCESS_OR_TERMINATE(
+      ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP));
+  active_period = false;
+
+  ssize_t size = read(fds[0], buffer, sizeof(buffer));
+  assert(size > 0);
+  (void)size;
+
+  for (unsigned int i = 0; i < number_perf_events; i++) {
+    values[i] = -1;
+  }
+
+  uint64_t time_enabled = buffer[1];
+  uint64_t time_running = buffer[2];
+  if (time_running == 0) {
+    group_never_scheduled = true;
+    _counter_enabled = false;
+    return;
+  }
+
+  long double scale = 1.0;
+  if (time_running < time_enabled) {
+    scale = static_cast<long double>(time_enabled) / time_running;
+    if (!multiplexing_reported || verbose) {
+      std::cerr << "WARNING : perf_event counters ran for "
+                << 100.0 * time_running / time_enabled
+                << "% of the measured period, values are scaled"
+                << std::endl;
+      multiplexing_reported = true;
+    }
+  }
+
+  for (uint64_t n = 0; n < buffer[0]; n++) {
+    for (unsigned int i = 0; i < number_perf_events; i++) {
+      if ((fds[i] != -1) && (ids[i] == buffer[4 + 2 * n])) {
+        values[i] = static_cast<long long>(buffer[3 + 2 * n] * scale);
+      }
+    }
+  }
+}
+
+void HardwareCounter::counter_asserts(void) {
+  /* No period was measured. start() and end() need to be called first */
+  assert(measurement_taken == true);
+
+  /*
+   * Period was not measured properly.
+   * start() was called without end().
+   */
+  assert(active_period == false);
+}
+
+long long HardwareCounter::counter_instructions(void) {
+  counter_asserts();
+  return values[0];
+}
+
+long long HardwareCounter::counter_cycles(void) {
+  counter_asserts();
+  return values[1];
+}
+
+long long HardwareCounter::counter_cache_misses(void) {
+  counter_asserts();
+  return values[2];
+}
+
+long long HardwareCounter::counter_branch_misses(void) {
+  counter_asserts();
+  return values[3];
+}
+
+long long HardwareCounter::counter_context_switches(void) {
+  counter_asserts();
+  return values[4];
+}
+
+bool HardwareCounter::is_supported(void) { return _counter_enabled; }
+
+std::string HardwareCounter::support_warning(void) {
+  std::ifstream paranoid_file("/proc/sys/kernel/perf_event_paranoid");
+  std::string paranoid;
+
+  if (group_never_scheduled) {
+    return "perf_event hardware counters could not be scheduled on the "
+           "PMU; another perf user or the NMI watchdog may hold them.";
+  }
+  if ((open_failed_errno != EACCES) && (open_failed_errno != EPERM)) {
+    return "perf_event_open of the " + std::string(open_failed_event) +
+           " counter failed: " + std::string(strerror(open_failed_errno));
+  }
+  if (!(paranoid_file >> paranoid)) {
+    return "perf_event_open is not permitted on this system.";
+  }
+  return "perf_event_open is not permitted with perf_event_paranoid = " +
+         paranoid + ". Decrease it with: sudo sh -c 'echo 1 "
+                    ">/proc/sys/kernel/perf_event_paranoid'";
+}
@@ -30,9 +30,24 @@ long long HardwareCounter::counter_cycles(void) {
   return -1;
 }
 
+long long HardwareCounter::counter_cache_misses(void) {
+  assert(0);
+  return -1;
+}
+
+long long HardwareCounter::counter_branch_misses(void) {
+  assert(0);
+  return -1;
+}
+
+long long HardwareCounter::counter_context_switches(void) {
+  assert(0);
+  return -1;
+}
+
 bool HardwareCounter::is_supported(void) { return false; }
 
 std::string HardwareCounter::support_warning(void) {
-  return "Hardware counters are not supported. Compile benchmark with the PAPI "
-         "library on Unix system";
+  return "Hardware counters are not supported. Compile benchmark on Linux, "
+         "or with the PAPI library on Unix system";
 }
@@ -102,6 +102,22 @@ long long HardwareCounter::counter_cycles(void) {
   return values[1];
 }
 
+/* Only instructions and cycles are counted with PAPI */
+long long HardwareCounter::counter_cache_misses(void) {
+  counter_asserts();
+  return -1;
+}
+
+long long HardwareCounter::counter_branch_misses(void) {
+  counter_asserts();
+  return -1;
+}
+
+long long HardwareCounter::counter_context_switches(void) {
+  counter_asserts();
+  return -1;
+}
+
 bool HardwareCounter::is_supported(void) { return _counter_enabled; }
 
 std::string HardwareCounter::support_warning(void) {
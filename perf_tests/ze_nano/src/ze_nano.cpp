@@ -9,6 +9,8 @@
 #include "benchmark.hpp"
 #include "gmock/gmock.h"
 
+#include <cstdint>
+#include <cstdlib>
 #include <iomanip>
 
 using namespace ze_api_benchmarks;
@@ -51,6 +53,7 @@ TEST_F(ZeNano, zeKernelSetArgumentValue_Buffer) {
 
   header_print_iteration("Buffer argument", probe_setting);
   latency::parameter_buffer(benchmark, probe_setting);
+  latency_distribution::parameter_buffer(benchmark, probe_setting);
   hardware_counter::parameter_buffer(benchmark, probe_setting);
   fuction_call_rate::parameter_buffer(benchmark, probe_setting);
   std::cout << std::endl;
@@ -62,6 +65,7 @@ TEST_F(ZeNano, zeKernelSetArgumentValue_Immediate) {
 
   header_print_iteration("Immediate argument", probe_setting);
   latency::parameter_integer(benchmark, probe_setting);
+  latency_distribution::parameter_integer(benchmark, probe_setting);
   hardware_counter::parameter_integer(benchmark, probe_setting);
   fuction_call_rate::parameter_integer(benchmark, probe_setting);
   std::cout << std::endl;
@@ -73,26 +77,58 @@ TEST_F(ZeNano, zeKernelSetArgumentValue_Image) {
 
   header_print_iteration("Image argument", probe_setting);
   latency::parameter_image(benchmark, probe_setting);
+  latency_distribution::parameter_image(benchmark, probe_setting);
   hardware_counter::parameter_image(benchmark, probe_setting);
   fuction_call_rate::parameter_image(benchmark, probe_setting);
   std::cout << std::endl;
 }
 
+TEST_F(ZeNano, zeKernelSetArgumentValue_Threads) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 0;
+
+  header_print_iteration("Threads", probe_setting);
+  probe_call_rate_scaling([this] {
+    probe_config_t thread_setting = probe_setting;
+    function_call_rate_threads::parameter_buffer(benchmark, thread_setting);
+  });
+  probe_call_rate_scaling([this] {
+    probe_config_t thread_setting = probe_setting;
+    function_call_rate_threads::parameter_integer(benchmark, thread_setting);
+  });
+  std::cout << std::endl;
+}
+
 TEST_F(ZeNano, zeCommandListAppendLaunchKernel) {
   probe_setting.warm_up_iteration = 500;
   probe_setting.measure_iteration = 2500;
 
   header_print_iteration("", probe_setting);
   latency::launch_function_no_parameter(benchmark, probe_setting);
+  latency_distribution::launch_function_no_parameter(benchmark, probe_setting);
   hardware_counter::launch_function_no_parameter(benchmark, probe_setting);
   std::cout << std::endl;
 }
 
+TEST_F(ZeNano, zeCommandListAppendLaunchKernel_Threads) {
+  probe_setting.warm_up_iteration = 500;
+  probe_setting.measure_iteration = 0;
+
+  header_print_iteration("Threads", probe_setting);
+  probe_call_rate_scaling([this] {
+    probe_config_t thread_setting = probe_setting;
+    function_call_rate_threads::launch_function_no_parameter(benchmark,
+                                                             thread_setting);
+  });
+  std::cout << std::endl;
+}
+
 TEST_F(ZeNano, zeCommandQueueExecuteCommandLists) {
   probe_setting.warm_up_iteration = 5;
   probe_setting.measure_iteration = 10;
   header_print_iteration("", probe_setting);
   latency::command_list_empty_execute(benchmark, probe_setting);
+  latency_distribution::command_list_empty_execute(benchmark, probe_setting);
   hardware_counter::command_list_empty_execute(benchmark, probe_setting);
   fuction_call_rate::command_list_empty_execute(benchmark, probe_setting);
   std::cout << std::endl;
@@ -103,14 +139,170 @@ TEST_F(ZeNano, zeDeviceGroupGetMemIpcHandle) {
   probe_setting.measure_iteration = 9000;
   header_print_iteration("", probe_setting);
   latency::ipc_memory_handle_get(benchmark, probe_setting);
+  latency_distribution::ipc_memory_handle_get(benchmark, probe_setting);
   hardware_counter::ipc_memory_handle_get(benchmark, probe_setting);
   fuction_call_rate::ipc_memory_handle_get(benchmark, probe_setting);
   std::cout << std::endl;
 }
+
+TEST_F(ZeNano, zeEventCreate) {
+  probe_setting.warm_up_iteration = 100;
+  probe_setting.measure_iteration = 900;
+
+  header_print_iteration("", probe_setting);
+  latency::event_create_destroy(benchmark, probe_setting);
+  latency_distribution::event_create_destroy(benchmark, probe_setting);
+  hardware_counter::event_create_destroy(benchmark, probe_setting);
+  fuction_call_rate::event_create_destroy(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeEventHostSignal) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 9000;
+
+  header_print_iteration("", probe_setting);
+  latency::event_host_signal(benchmark, probe_setting);
+  latency_distribution::event_host_signal(benchmark, probe_setting);
+  hardware_counter::event_host_signal(benchmark, probe_setting);
+  fuction_call_rate::event_host_signal(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeEventQueryStatus) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 9000;
+
+  header_print_iteration("", probe_setting);
+  latency::event_query_status(benchmark, probe_setting);
+  latency_distribution::event_query_status(benchmark, probe_setting);
+  hardware_counter::event_query_status(benchmark, probe_setting);
+  fuction_call_rate::event_query_status(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeEventHostReset) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 9000;
+
+  header_print_iteration("", probe_setting);
+  latency::event_host_reset(benchmark, probe_setting);
+  latency_distribution::event_host_reset(benchmark, probe_setting);
+  hardware_counter::event_host_reset(benchmark, probe_setting);
+  fuction_call_rate::event_host_reset(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeFenceQueryStatus) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 9000;
+
+  header_print_iteration("", probe_setting);
+  latency::fence_query_status(benchmark, probe_setting);
+  latency_distribution::fence_query_status(benchmark, probe_setting);
+  hardware_counter::fence_query_status(benchmark, probe_setting);
+  fuction_call_rate::fence_query_status(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeMemAlloc) {
+  probe_setting.warm_up_iteration = 10;
+  probe_setting.measure_iteration = 90;
+
+  header_print_iteration("", probe_setting);
+  latency::memory_alloc_free(benchmark, probe_setting);
+  latency_distribution::memory_alloc_free(benchmark, probe_setting);
+  hardware_counter::memory_alloc_free(benchmark, probe_setting);
+  fuction_call_rate::memory_alloc_free(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeMemGetAllocProperties) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 9000;
+
+  header_print_iteration("", probe_setting);
+  latency::memory_get_alloc_properties(benchmark, probe_setting);
+  latency_distribution::memory_get_alloc_properties(benchmark, probe_setting);
+  hardware_counter::memory_get_alloc_properties(benchmark, probe_setting);
+  fuction_call_rate::memory_get_alloc_properties(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeCommandListReset) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 9000;
+
+  header_print_iteration("", probe_setting);
+  latency::command_list_reset(benchmark, probe_setting);
+  latency_distribution::command_list_reset(benchmark, probe_setting);
+  hardware_counter::command_list_reset(benchmark, probe_setting);
+  fuction_call_rate::command_list_reset(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeCommandListAppendMemoryCopy) {
+  probe_setting.warm_up_iteration = 500;
+  probe_setting.measure_iteration = 2500;
+
+  header_print_iteration("", probe_setting);
+  latency::memory_copy_append(benchmark, probe_setting);
+  latency_distribution::memory_copy_append(benchmark, probe_setting);
+  hardware_counter::memory_copy_append(benchmark, probe_setting);
+  std::cout << std::endl;
+}
+
+TEST_F(ZeNano, zeKernelSetGroupSize) {
+  probe_setting.warm_up_iteration = 1000;
+  probe_setting.measure_iteration = 9000;
+
+  header_print_iteration("", probe_setting);
+  latency::kernel_group_size(benchmark, probe_setting);
+  latency_distribution::kernel_group_size(benchmark, probe_setting);
+  hardware_counter::kernel_group_size(benchmark, probe_setting);
+  fuction_call_rate::kernel_group_size(benchmark, probe_setting);
+  std::cout << std::endl;
+}
 } /* end namespace */
 
+static const char *usage_str =
+    "\n ze_nano [gtest options] [OPTIONS]"
+    "\n"
+    "\n OPTIONS:"
+    "\n  --cpu=N                    pin the measuring thread to CPU N"
+    "\n  --fifo                     run the measuring thread with SCHED_FIFO"
+    "\n                             when permitted"
+    "\n";
+
 int main(int argc, char **argv) {
+  ProbeIsolation isolation;
+
+  /* gtest removes the options it recognizes from argv */
   ::testing::InitGoogleTest(&argc, argv);
+  for (int i = 1; i < argc; i++) {
+    std::string argument(argv[i]);
+    char *end = nullptr;
+
+    if (argument.compare(0, 6, "--cpu=") == 0) {
+      long cpu = std::strtol(argument.c_str() + 6, &end, 10);
+      if (end == argument.c_str() + 6 || *end != '\0' || cpu < 0 ||
+          cpu > INT32_MAX) {
+        std::cerr << "ERROR : invalid CPU " << argument.substr(6) << std::endl;
+        std::cout << usage_str;
+        return 1;
+      }
+      isolation.cpu = static_cast<int>(cpu);
+    } else if (argument == "--fifo") {
+      isolation.realtime = true;
+    } else {
+      std::cerr << "ERROR : unknown option " << argument << std::endl;
+      std::cout << usage_str;
+      return 1;
+    }
+  }
+
+  /* Test cases run on this thread */
+  probe_isolate_current_thread(isolation);
   return RUN_ALL_TESTS();
   std::cout << std::flush;
 }
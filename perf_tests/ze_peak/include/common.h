@@ -34,4 +34,87 @@ class Timer {
 
 uint64_t roundToMultipleOf(uint64_t number, uint64_t base, uint64_t maxValue);
 
+//---------------------------------------------------------------------
+// Where the host-observed time of a submission went, measured with
+// kernel timestamps. All values are means in micro-seconds. When the
+// device clock could be correlated with the host clock, the gap between
+// host and device time is split into launch (submission to the start of
+// execution) and completion (end of execution to the host seeing it).
+//---------------------------------------------------------------------
+struct TimestampBreakdown {
+  bool valid = false;
+  bool correlated = false;
+  long double host = 0;
+  long double device = 0;
+  long double launch = 0;
+  long double completion = 0;
+};
+
+//---------------------------------------------------------------------
+// Device power, frequency and temperature sampled with Sysman while a
+// test ran. Power is the average in watts over the run, frequency the
+// average actual GPU frequency in MHz and temperature the highest seen,
+// in degrees Celsius. throttled is set if the driver reported any
+// throttle reason during the run.
+//---------------------------------------------------------------------
+struct SysmanReading {
+  bool valid = false;
+  bool has_power = false;
+  bool has_frequency = false;
+  bool has_temperature = false;
+  long double power = 0;
+  long double frequency = 0;
+  long double min_frequency = 0;
+  long double temperature = 0;
+  bool throttled = false;
+  uint32_t throttle_reasons = 0;
+};
+
+//---------------------------------------------------------------------
+// Summary of a set of timing samples. All values are in micro-seconds
+// except cv (coefficient of variation, stddev / mean) which is a ratio.
+// ci95 is the half-width of the 95% confidence interval of the mean.
+//---------------------------------------------------------------------
+struct SampleStatistics {
+  size_t count = 0;
+  long double mean = 0;
+  long double min = 0;
+  long double max = 0;
+  long double median = 0;
+  long double p90 = 0;
+  long double p99 = 0;
+  long double p999 = 0;
+  long double stddev = 0;
+  long double cv = 0;
+  long double ci95 = 0;
+  /* Only set when timing with events */
+  TimestampBreakdown timestamps;
+  /* Only set when sampling with Sysman */
+  SysmanReading sysman;
+};
+
+//---------------------------------------------------------------------
+// Collects one timing sample per iteration. The running mean and
+// variance are kept up to date (Welford) so the confidence interval
+// can be checked after every sample without re-scanning the samples.
+//---------------------------------------------------------------------
+class SampleCollector {
+public:
+  void reserve(size_t count);
+  void add(long double sample);
+  void clear();
+  size_t size() const;
+
+  // Half-width of the 95% confidence interval relative to the mean
+  long double relative_ci95() const;
+  SampleStatistics statistics() const;
+  // Number of samples in each power-of-two bucket: [0, 1), [1, 2), [2, 4)..
+  std::vector<size_t> log2_histogram() const;
+
+private:
+  std::vector<long double> samples;
+  long double running_mean = 0;
+  long double running_m2 = 0;
+};
+
 #endif /* COMMON_H */
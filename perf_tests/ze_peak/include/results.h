@@ -0,0 +1,56 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include "../include/common.h"
+
+/* ze includes */
+#include <level_zero/ze_api.h>
+
+#include <boost/property_tree/ptree.hpp>
+
+struct ZePeakResult {
+  std::string test;
+  std::string variant;
+  uint32_t vector_width = 1;
+  std::string units;
+  long double value = 0;
+  SampleStatistics stats;
+  std::string device_name;
+  std::string device_uuid;
+};
+
+//---------------------------------------------------------------------
+// Collects every measurement taken by ze_peak, together with the
+// properties of the device it was taken on, and writes them out as
+// JSON and/or CSV once all the tests have run.
+//---------------------------------------------------------------------
+class ResultsSink {
+public:
+  std::string json_file_name;
+  std::string csv_file_name;
+
+  bool is_enabled() const;
+  void add_device(const ze_device_properties_t &props);
+  void add(const ZePeakResult &result);
+  void write() const;
+
+private:
+  void write_json() const;
+  void write_csv() const;
+
+  boost::property_tree::ptree devices;
+  std::vector<std::string> device_uuids;
+  std::vector<ZePeakResult> results;
+};
+
+std::string device_uuid_to_string(const ze_device_uuid_t &uuid);
+
+#endif /* RESULTS_H */
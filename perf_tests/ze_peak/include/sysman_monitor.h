@@ -0,0 +1,60 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#ifndef SYSMAN_MONITOR_H
+#define SYSMAN_MONITOR_H
+
+#include "../include/common.h"
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+/* ze includes */
+#include <level_zero/ze_api.h>
+#include <level_zero/zes_api.h>
+
+void enable_sysman();
+
+//---------------------------------------------------------------------
+// Samples the frequency, power and temperature of a device with Sysman
+// on a background thread, between start() and stop(). Domains the
+// device does not report are left out of the reading. A sub-device is
+// monitored through its root device, with only the domains of that
+// sub-device.
+//---------------------------------------------------------------------
+class SysmanMonitor {
+public:
+  ~SysmanMonitor();
+
+  void init(ze_device_handle_t root_device, bool on_subdevice = false,
+            uint32_t subdevice_id = 0);
+  bool available() const;
+  void start();
+  SysmanReading stop();
+
+  /* Time between two samples of the background thread */
+  uint32_t period_ms = 10;
+
+private:
+  void sample();
+
+  std::vector<zes_freq_handle_t> frequency_domains;
+  std::vector<zes_temp_handle_t> temperature_sensors;
+  zes_pwr_handle_t power_domain = nullptr;
+
+  std::thread sampler;
+  std::atomic<bool> sampling{false};
+  std::mutex reading_mutex;
+  SysmanReading reading;
+  long double frequency_sum = 0;
+  uint32_t frequency_samples = 0;
+  zes_power_energy_counter_t start_energy = {};
+};
+
+#endif /* SYSMAN_MONITOR_H */
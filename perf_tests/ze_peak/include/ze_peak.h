@@ -10,6 +10,10 @@
 #define ZE_PEAK_H
 
 #include "../include/common.h"
+#include "../include/results.h"
+#include "../include/sysman_monitor.h"
+
+#include <memory>
 
 /* ze includes */
 #include <level_zero/ze_api.h>
@@ -40,6 +44,23 @@ enum class TimingMeasurement {
   KERNEL_COMPLETE_RUNTIME
 };
 
+/* How a launch is submitted, and how its completion is waited for */
+enum class LatencyMode {
+  QUEUE_SYNCHRONIZE,
+  QUEUE_EVENT,
+  IMMEDIATE_ASYNC_EVENT,
+  IMMEDIATE_SYNCHRONOUS
+};
+
+/* Time spent creating modules, and how many came from the module cache */
+struct ModuleLoadStatistics {
+  uint32_t modules = 0;
+  uint32_t cache_hits = 0;
+  long double time_us = 0;
+
+  void add(const ModuleLoadStatistics &other);
+};
+
 struct L0Context {
   ze_command_queue_handle_t command_queue = nullptr;
   ze_command_queue_handle_t copy_command_queue = nullptr;
@@ -55,14 +76,32 @@ struct L0Context {
   ze_device_properties_t device_property;
   ze_device_compute_properties_t device_compute_property;
   bool verbose = false;
+  /* false when the context is shared with the L0Context it was created from */
+  bool owns_context = true;
+  /* Directory of the native module cache, empty when caching is off */
+  std::string module_cache_dir;
+  ModuleLoadStatistics module_loads;
+  /* Sample power, frequency and temperature while kernels run */
+  bool use_sysman = false;
+  std::shared_ptr<SysmanMonitor> sysman;
 
   void init_xe(uint32_t specified_platform, uint32_t specified_device);
+  void init_xe(const L0Context &parent, ze_device_handle_t selected_device);
+  void init_driver(uint32_t specified_platform);
+  void init_device(ze_device_handle_t selected_device);
+  std::vector<ze_device_handle_t> get_devices(bool include_subdevices);
+  std::vector<ze_device_handle_t> get_sub_devices(ze_device_handle_t device);
+  ze_device_handle_t get_root_device(ze_device_handle_t sub_device);
   void clean_xe();
   void print_ze_device_properties(const ze_device_properties_t &props);
   void reset_commandlist(ze_command_list_handle_t cmd_list);
   void execute_commandlist_and_sync(bool use_copy_only_queue = false);
   std::vector<uint8_t> load_binary_file(const std::string &file_path);
   void create_module(std::vector<uint8_t> binary_file);
+  std::vector<std::string> get_kernel_names();
+  std::string module_cache_path(const std::vector<uint8_t> &binary_file);
+  bool create_module_from_cache(const std::string &cache_path);
+  void save_module_to_cache(const std::string &cache_path);
 };
 
 struct ZeWorkGroups {
@@ -72,6 +111,53 @@ struct ZeWorkGroups {
   uint32_t group_size_z;
 };
 
+/* A kernel with its buffers, set up to run on one tile in concurrent mode */
+struct TileWorkload {
+  void *input = nullptr;
+  void *output = nullptr;
+  ze_kernel_handle_t kernel = nullptr;
+  struct ZeWorkGroups workgroup_info;
+  /* bytes or operations processed by one launch of kernel */
+  long double work_per_launch = 0;
+};
+
+/* Per submission samples behind a TimestampBreakdown */
+struct TimestampSamples {
+  SampleCollector host;
+  SampleCollector device;
+  SampleCollector launch;
+  SampleCollector completion;
+  /* false once the device clock could not be read for a sample */
+  bool correlated = true;
+
+  TimestampBreakdown breakdown() const;
+};
+
+/* How the input value is passed to a compute kernel */
+enum class ComputeInput { BUFFER, SCALAR };
+
+struct ComputeKernel {
+  const char *name;
+  const char *variant;
+  uint32_t vector_width;
+  /* operations done by one work item, a mad counting as two */
+  uint32_t ops_per_work_item;
+};
+
+/* A compute test: a SPIR-V module and the kernels to run from it */
+struct ComputeTest {
+  const char *test;
+  const char *title;
+  const char *binary_file;
+  /* size of one output element */
+  size_t element_size;
+  uint32_t work_item_multiplier;
+  ComputeInput input;
+  const void *input_value;
+  size_t input_size;
+  std::vector<ComputeKernel> kernels;
+};
+
 class ZePeak {
 public:
   bool use_event_timer = false;
@@ -83,20 +169,60 @@ public:
   bool run_int_compute = true;
   bool run_transfer_bw = true;
   bool run_kernel_lat = true;
+  /* The working set sweep is long, so it only runs with -t working_set */
+  bool run_working_set = false;
+  bool run_overlap = true;
+  bool run_all_devices = false;
+  bool run_concurrent = false;
+  /* Also split transfers into chunks spread over compute and copy engines */
+  bool run_pipelined_transfer = false;
+  /* Directory of the native module cache, empty when caching is off */
+  std::string module_cache_dir;
+  /* Sample power, frequency and temperature with Sysman */
+  bool use_sysman = false;
   uint32_t specified_platform = 0;
   uint32_t specified_device = 0;
   uint32_t global_bw_max_size = 1 << 29;
   uint32_t transfer_bw_max_size = 1 << 29;
   uint32_t iters = 50;
   uint32_t warmup_iterations = 10;
+  /* Samples per mode in the launch latency distribution */
+  uint32_t latency_iters = 10000;
+  /* Auto-iteration: relative 95% CI half-width to reach, 0 disables it */
+  long double confidence_target = 0;
+  uint32_t max_iters = 1000;
+  /* Batched mode: launches recorded per command list, 0 disables it */
+  uint32_t batch_size = 0;
+  bool batch_barriers = false;
+  ResultsSink results;
 
   int parse_arguments(int argc, char **argv);
 
   /* Helper Functions */
-  long double run_kernel(L0Context context, ze_kernel_handle_t &function,
-                         struct ZeWorkGroups &workgroup_info,
-                         TimingMeasurement type,
-                         bool reset_command_list = true);
+  SampleStatistics run_kernel(L0Context context, ze_kernel_handle_t &function,
+                              struct ZeWorkGroups &workgroup_info,
+                              TimingMeasurement type,
+                              bool reset_command_list = true);
+  SampleStatistics run_kernel_batched(L0Context context,
+                                      ze_kernel_handle_t &function,
+                                      struct ZeWorkGroups &workgroup_info);
+  bool sampling_complete(const SampleCollector &samples);
+  void print_timing_statistics(const SampleStatistics &stats);
+  void print_timestamp_breakdown(const TimestampBreakdown &timestamps);
+  void print_sysman_reading(const SysmanReading &reading, long double value,
+                            const std::string &units);
+  void report_result(L0Context &context, const std::string &test,
+                     const std::string &variant, uint32_t vector_width,
+                     long double value, const std::string &units,
+                     const SampleStatistics &stats = SampleStatistics());
+  void report_batched_result(L0Context &context, ze_kernel_handle_t &function,
+                             struct ZeWorkGroups &workgroup_info,
+                             const std::string &test,
+                             const std::string &variant,
+                             uint32_t vector_width,
+                             long double work_per_launch,
+                             const std::string &units,
+                             const SampleStatistics &per_submit);
   uint64_t set_workgroups(L0Context &context,
                           const uint64_t total_work_items_requested,
                           struct ZeWorkGroups *workgroup_info);
@@ -105,6 +231,7 @@ public:
                       size_t outputSize = 0u);
   uint64_t get_max_work_items(L0Context &context);
   void print_test_complete();
+  void print_module_loads(const ModuleLoadStatistics &module_loads);
   void run_command_queue(L0Context &context);
   void synchronize_command_queue(L0Context &context);
   /* Benchmark Functions*/
@@ -114,21 +241,65 @@ public:
   void ze_peak_sp_compute(L0Context &context);
   void ze_peak_dp_compute(L0Context &context);
   void ze_peak_int_compute(L0Context &context);
+  void run_compute_test(L0Context &context, const ComputeTest &test);
   void ze_peak_transfer_bw(L0Context &context);
+  void ze_peak_working_set(L0Context &context);
+  void ze_peak_overlap(L0Context &context);
+  void run_selected_tests(L0Context &context);
+  void ze_peak_all_devices(L0Context &context);
+  void ze_peak_concurrent(L0Context &context);
 
 private:
-  void _transfer_bw_gpu_copy(L0Context &context, void *destination_buffer,
-                             void *source_buffer, size_t buffer_size);
-  void _transfer_bw_host_copy(L0Context &context, void *destination_buffer,
-                              void *source_buffer, size_t buffer_size,
-                              bool shared_is_dest);
+  void _transfer_bw_gpu_copy(L0Context &context, const std::string &variant,
+                             void *destination_buffer, void *source_buffer,
+                             size_t buffer_size);
+  void _transfer_bw_host_copy(L0Context &context, const std::string &variant,
+                              void *destination_buffer, void *source_buffer,
+                              size_t buffer_size, bool shared_is_dest);
+  TimestampBreakdown _transfer_bw_event_copy(L0Context &context,
+                                             bool use_copy_queue,
+                                             void *destination_buffer,
+                                             void *source_buffer,
+                                             size_t buffer_size);
+  void _transfer_bw_pinned_memory(L0Context &context, void *device_buffer,
+                                  size_t buffer_size);
+  void _transfer_bw_pipelined(L0Context &context, const std::string &variant,
+                              void *destination_buffer, void *source_buffer,
+                              size_t buffer_size);
   void _transfer_bw_shared_memory(L0Context &context,
                                   std::vector<float> local_memory);
+  void _global_bw_access_patterns(L0Context &context, void *input_buffer,
+                                  void *output_buffer,
+                                  uint64_t number_of_items);
+  SampleCollector _measure_launch_to_completion(
+      L0Context &context, ze_kernel_handle_t &function,
+      struct ZeWorkGroups &workgroup_info, LatencyMode mode);
+  void _print_latency_histogram(const SampleCollector &samples);
+  void _setup_tile_global_bw(L0Context &context, TileWorkload &workload);
+  void _setup_tile_sp_compute(L0Context &context, TileWorkload &workload);
+  void _release_tile_workload(L0Context &context, TileWorkload &workload);
+  void _run_tiles_concurrently(std::vector<L0Context> &tiles,
+                               std::vector<TileWorkload> &workloads,
+                               const std::string &test,
+                               const std::string &units);
   TimingMeasurement is_bandwidth_with_event_timer(void);
   long double calculate_gbps(long double period, long double buffer_size);
   long double context_time_in_us(L0Context &context, ze_event_handle_t &event);
+  long double timestamp_ticks_to_us(L0Context &context, uint64_t start,
+                                    uint64_t end);
+  bool read_device_timestamp(L0Context &context, uint64_t &timestamp);
+  void add_timestamp_sample(L0Context &context, TimestampSamples &samples,
+                            ze_event_handle_t first_event,
+                            ze_event_handle_t last_event,
+                            uint64_t submit_timestamp, bool correlated,
+                            long double host_time);
 };
 
 TimingMeasurement is_bandwidth_with_event_timer(void);
+void single_event_pool_create(L0Context &context,
+                              ze_event_pool_handle_t *kernel_launch_event_pool,
+                              ze_event_pool_flags_t flags);
+void single_event_create(ze_event_pool_handle_t event_pool,
+                         ze_event_handle_t *event);
 
 #endif /* ZE_PEAK_H */
@@ -0,0 +1,88 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#undef FETCH_2
+#undef FETCH_8
+
+#define FETCH_2(sum, id, A, jumpBy)      sum += A[id];   id += jumpBy;   sum += A[id];   id += jumpBy;
+#define FETCH_4(sum, id, A, jumpBy)      FETCH_2(sum, id, A, jumpBy);   FETCH_2(sum, id, A, jumpBy);
+#define FETCH_8(sum, id, A, jumpBy)      FETCH_4(sum, id, A, jumpBy);   FETCH_4(sum, id, A, jumpBy);
+
+#define FETCH_PER_WI  16
+
+// Access pattern kernels. Every work item touches FETCH_PER_WI elements,
+// and consecutive work items touch consecutive elements unless a stride
+// or an index buffer says otherwise.
+#define GATHER_2(sum, id, A, I, jumpBy)  sum += A[I[id]];   id += jumpBy;   sum += A[I[id]];   id += jumpBy;
+#define GATHER_4(sum, id, A, I, jumpBy)  GATHER_2(sum, id, A, I, jumpBy);   GATHER_2(sum, id, A, I, jumpBy);
+#define GATHER_8(sum, id, A, I, jumpBy)  GATHER_4(sum, id, A, I, jumpBy);   GATHER_4(sum, id, A, I, jumpBy);
+
+#define STORE_2(value, id, B, jumpBy)    B[id] = value;   id += jumpBy;   B[id] = value;   id += jumpBy;
+#define STORE_4(value, id, B, jumpBy)    STORE_2(value, id, B, jumpBy);   STORE_2(value, id, B, jumpBy);
+#define STORE_8(value, id, B, jumpBy)    STORE_4(value, id, B, jumpBy);   STORE_4(value, id, B, jumpBy);
+
+#define COPY_2(id, A, B, jumpBy)         B[id] = A[id];   id += jumpBy;   B[id] = A[id];   id += jumpBy;
+#define COPY_4(id, A, B, jumpBy)         COPY_2(id, A, B, jumpBy);   COPY_2(id, A, B, jumpBy);
+#define COPY_8(id, A, B, jumpBy)         COPY_4(id, A, B, jumpBy);   COPY_4(id, A, B, jumpBy);
+
+#define RMW_2(id, A, jumpBy)             A[id] = A[id] * 0.5f + 1.0f;   id += jumpBy;   A[id] = A[id] * 0.5f + 1.0f;   id += jumpBy;
+#define RMW_4(id, A, jumpBy)             RMW_2(id, A, jumpBy);   RMW_2(id, A, jumpBy);
+#define RMW_8(id, A, jumpBy)             RMW_4(id, A, jumpBy);   RMW_4(id, A, jumpBy);
+
+// Reads every stride-th element of A
+__kernel void global_bandwidth_strided(__global float *A, __global float *B, uint stride)
+{
+    size_t id = get_global_id(0) * stride;
+    size_t jump = get_global_size(0) * stride;
+    float sum = 0;
+
+    FETCH_8(sum, id, A, jump);
+    FETCH_8(sum, id, A, jump);
+
+    B[get_global_id(0)] = sum;
+}
+
+// Reads A through a precomputed index buffer I
+__kernel void global_bandwidth_gather(__global float *A, __global float *B, __global const uint *I)
+{
+    size_t id = get_global_id(0);
+    float sum = 0;
+
+    GATHER_8(sum, id, A, I, get_global_size(0));
+    GATHER_8(sum, id, A, I, get_global_size(0));
+
+    B[get_global_id(0)] = sum;
+}
+
+// Writes B without reading anything
+__kernel void global_bandwidth_write_only(__global float *A, __global float *B)
+{
+    size_t id = get_global_id(0);
+    float value = (float)get_local_id(0);
+
+    STORE_8(value, id, B, get_global_size(0));
+    STORE_8(value, id, B, get_global_size(0));
+}
+
+// Reads A and writes it to B
+__kernel void global_bandwidth_copy(__global float *A, __global float *B)
+{
+    size_t id = get_global_id(0);
+
+    COPY_8(id, A, B, get_global_size(0));
+    COPY_8(id, A, B, get_global_size(0));
+}
+
+// Reads A, updates it and writes it back in place
+__kernel void global_bandwidth_read_modify_write(__global float *A, __global float *B)
+{
+    size_t id = get_global_id(0);
+
+    RMW_8(id, A, get_global_size(0));
+    RMW_8(id, A, get_global_size(0));
+}
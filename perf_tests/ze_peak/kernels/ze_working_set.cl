@@ -0,0 +1,33 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#undef FETCH_2
+#undef FETCH_8
+
+#define FETCH_2(sum, id, A, jumpBy)      sum += A[id];   id += jumpBy;   sum += A[id];   id += jumpBy;
+#define FETCH_4(sum, id, A, jumpBy)      FETCH_2(sum, id, A, jumpBy);   FETCH_2(sum, id, A, jumpBy);
+#define FETCH_8(sum, id, A, jumpBy)      FETCH_4(sum, id, A, jumpBy);   FETCH_4(sum, id, A, jumpBy);
+
+#define FETCH_PER_WI  16
+
+// global_bandwidth_v4_local_offset of ze_global_bw.cl repeated over the
+// same elements passes times. offset_mask is always 0; it only makes the
+// addresses depend on the pass so that the loads are not hoisted.
+__kernel void global_bandwidth_v4_passes(__global float4 *A, __global float *B, uint passes, uint offset_mask)
+{
+    float4 sum = 0;
+
+    for (uint pass = 0; pass < passes; pass++) {
+        int id = (get_group_id(0) * get_local_size(0) * FETCH_PER_WI) + get_local_id(0) + (pass & offset_mask);
+
+        FETCH_8(sum, id, A, get_local_size(0));
+        FETCH_8(sum, id, A, get_local_size(0));
+    }
+
+    B[get_global_id(0)] = (sum.S0) + (sum.S1) + (sum.S2) + (sum.S3);
+}
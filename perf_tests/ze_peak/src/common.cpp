@@ -8,6 +8,9 @@
 
 #include "../include/common.h"
 
+#include <algorithm>
+#include <limits>
+
 using namespace std;
 
 void Timer::start() { tick = chrono::high_resolution_clock::now(); }
@@ -23,3 +26,87 @@ uint64_t roundToMultipleOf(uint64_t number, uint64_t base, uint64_t maxValue) {
   uint64_t n = (number > maxValue) ? maxValue : number;
   return (n / base) * base;
 }
+
+void SampleCollector::reserve(size_t count) { samples.reserve(count); }
+
+void SampleCollector::add(long double sample) {
+  samples.push_back(sample);
+  long double delta = sample - running_mean;
+  running_mean += delta / static_cast<long double>(samples.size());
+  running_m2 += delta * (sample - running_mean);
+}
+
+void SampleCollector::clear() {
+  samples.clear();
+  running_mean = 0;
+  running_m2 = 0;
+}
+
+size_t SampleCollector::size() const { return samples.size(); }
+
+static long double confidence_interval_95(long double stddev, size_t count) {
+  // Normal approximation, good enough for the iteration counts used here
+  return 1.96L * stddev / sqrtl(static_cast<long double>(count));
+}
+
+long double SampleCollector::relative_ci95() const {
+  if (samples.size() < 2 || running_mean <= 0)
+    return std::numeric_limits<long double>::infinity();
+
+  long double stddev =
+      sqrtl(running_m2 / static_cast<long double>(samples.size() - 1));
+  return confidence_interval_95(stddev, samples.size()) / running_mean;
+}
+
+//---------------------------------------------------------------------
+// Percentile of a sorted set of samples, linearly interpolated between
+// the two closest ranks.
+//---------------------------------------------------------------------
+static long double percentile(const std::vector<long double> &sorted,
+                              long double fraction) {
+  long double rank = fraction * static_cast<long double>(sorted.size() - 1);
+  size_t lower = static_cast<size_t>(rank);
+  size_t upper = std::min(lower + 1, sorted.size() - 1);
+  long double weight = rank - static_cast<long double>(lower);
+  return sorted[lower] + (sorted[upper] - sorted[lower]) * weight;
+}
+
+SampleStatistics SampleCollector::statistics() const {
+  SampleStatistics stats;
+  stats.count = samples.size();
+  if (samples.empty())
+    return stats;
+
+  std::vector<long double> sorted(samples);
+  std::sort(sorted.begin(), sorted.end());
+
+  stats.mean = running_mean;
+  stats.min = sorted.front();
+  stats.max = sorted.back();
+  stats.median = percentile(sorted, 0.5L);
+  stats.p90 = percentile(sorted, 0.9L);
+  stats.p99 = percentile(sorted, 0.99L);
+  stats.p999 = percentile(sorted, 0.999L);
+  if (sorted.size() > 1) {
+    stats.stddev =
+        sqrtl(running_m2 / static_cast<long double>(sorted.size() - 1));
+    stats.ci95 = confidence_interval_95(stats.stddev, sorted.size());
+  }
+  if (stats.mean > 0)
+    stats.cv = stats.stddev / stats.mean;
+
+  return stats;
+}
+
+std::vector<size_t> SampleCollector::log2_histogram() const {
+  std::vector<size_t> buckets;
+  for (auto sample : samples) {
+    size_t bucket = 0;
+    for (long double edge = 1; sample >= edge; edge *= 2)
+      bucket++;
+    if (bucket >= buckets.size())
+      buckets.resize(bucket + 1, 0);
+    buckets[bucket]++;
+  }
+  return buckets;
+}
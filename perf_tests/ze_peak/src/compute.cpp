@@ -0,0 +1,261 @@
+/*
+ *
+ * Copyright (C) 2019-2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "../include/ze_peak.h"
+
+#include <algorithm>
+
+// There is no equivalent of cl_half (i.e. 16 bit floating point)
+// in the C/C++ standard. So we are just going to allocate 16 bits
+// using a C type knowing it will be the same size.
+#define cl_half uint16_t
+
+static const float sp_input_value = 1.3f;
+static const double dp_input_value = 1.3f;
+static const int int_input_value = 4;
+static const float hp_input_value = 1.3f;
+
+/*
+ * The kernels of each test, as defined in kernels/ze_*_compute.cl. A mad,
+ * including the integer mad of int_compute, counts as two operations.
+ * Multipliers are the same as in clPeak.
+ */
+static const ComputeTest hp_compute_test = {
+    "hp_compute",
+    "Half Precision Compute (GFLOPS)",
+    "ze_hp_compute.spv",
+    sizeof(cl_half),
+    2048,
+    ComputeInput::SCALAR,
+    &hp_input_value,
+    sizeof(hp_input_value),
+    {{"compute_hp_v1", "half", 1, 4096},
+     {"compute_hp_v2", "half2", 2, 4096},
+     {"compute_hp_v4", "half4", 4, 4096},
+     {"compute_hp_v8", "half8", 8, 4096},
+     {"compute_hp_v16", "half16", 16, 4096}}};
+
+static const ComputeTest sp_compute_test = {
+    "sp_compute",
+    "Single Precision Compute (GFLOPS)",
+    "ze_sp_compute.spv",
+    sizeof(float),
+    2048,
+    ComputeInput::BUFFER,
+    &sp_input_value,
+    sizeof(sp_input_value),
+    {{"compute_sp_v1", "float", 1, 4096},
+     {"compute_sp_v2", "float2", 2, 4096},
+     {"compute_sp_v4", "float4", 4, 4096},
+     {"compute_sp_v8", "float8", 8, 4096},
+     {"compute_sp_v16", "float16", 16, 4096}}};
+
+static const ComputeTest dp_compute_test = {
+    "dp_compute",
+    "Double Precision Compute (GFLOPS)",
+    "ze_dp_compute.spv",
+    sizeof(double),
+    512,
+    ComputeInput::BUFFER,
+    &dp_input_value,
+    sizeof(dp_input_value),
+    {{"compute_dp_v1", "double", 1, 4096},
+     {"compute_dp_v2", "double2", 2, 4096},
+     {"compute_dp_v4", "double4", 4, 4096},
+     {"compute_dp_v8", "double8", 8, 4096},
+     {"compute_dp_v16", "double16", 16, 4096}}};
+
+static const ComputeTest int_compute_test = {
+    "int_compute",
+    "Integer Compute (GFLOPS)",
+    "ze_int_compute.spv",
+    sizeof(int),
+    2048,
+    ComputeInput::BUFFER,
+    &int_input_value,
+    sizeof(int_input_value),
+    {{"compute_int_v1", "int", 1, 2048},
+     {"compute_int_v2", "int2", 2, 2048},
+     {"compute_int_v4", "int4", 4, 2048},
+     {"compute_int_v8", "int8", 8, 2048},
+     {"compute_int_v16", "int16", 16, 2048}}};
+
+void ZePeak::ze_peak_hp_compute(L0Context &context) {
+  run_compute_test(context, hp_compute_test);
+}
+
+void ZePeak::ze_peak_sp_compute(L0Context &context) {
+  run_compute_test(context, sp_compute_test);
+}
+
+void ZePeak::ze_peak_dp_compute(L0Context &context) {
+  run_compute_test(context, dp_compute_test);
+}
+
+void ZePeak::ze_peak_int_compute(L0Context &context) {
+  run_compute_test(context, int_compute_test);
+}
+
+//---------------------------------------------------------------------
+// Runs every kernel of a compute test, one after the other, on the same
+// work size and buffers. The kernel input is either a one element device
+// buffer or a scalar kernel argument, as described by the test.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::run_compute_test(L0Context &context, const ComputeTest &test) {
+  long double gflops;
+  SampleStatistics timed;
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  TimingMeasurement type = is_bandwidth_with_event_timer();
+  struct ZeWorkGroups workgroup_info;
+
+  std::vector<uint8_t> binary_file = context.load_binary_file(test.binary_file);
+
+  context.create_module(binary_file);
+
+  uint64_t max_work_items =
+      get_max_work_items(context) * test.work_item_multiplier;
+  uint64_t max_number_of_allocated_items =
+      context.device_property.maxMemAllocSize / test.element_size;
+  uint64_t number_of_work_items = MIN(max_number_of_allocated_items,
+                                      (max_work_items * test.element_size));
+
+  number_of_work_items =
+      set_workgroups(context, number_of_work_items, &workgroup_info);
+
+  void *device_input_value = nullptr;
+  if (test.input == ComputeInput::BUFFER) {
+    ze_device_mem_alloc_desc_t in_device_desc = {};
+    in_device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+    in_device_desc.pNext = nullptr;
+    in_device_desc.ordinal = 0;
+    in_device_desc.flags = 0;
+    result = zeMemAllocDevice(context.context, &in_device_desc,
+                              test.input_size, 1, context.device,
+                              &device_input_value);
+    if (result) {
+      throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "device input value allocated\n";
+  }
+
+  void *device_output_buffer;
+  ze_device_mem_alloc_desc_t out_device_desc = {};
+  out_device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+  out_device_desc.pNext = nullptr;
+  out_device_desc.ordinal = 0;
+  out_device_desc.flags = 0;
+  result = zeMemAllocDevice(
+      context.context, &out_device_desc,
+      static_cast<size_t>((number_of_work_items * test.element_size)), 1,
+      context.device, &device_output_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "device output buffer allocated\n";
+
+  if (test.input == ComputeInput::BUFFER) {
+    result = zeCommandListAppendMemoryCopy(
+        context.command_list, device_input_value, test.input_value,
+        test.input_size, nullptr, 0, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandListAppendMemoryCopy failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "Input value copy encoded\n";
+
+    result =
+        zeCommandListAppendBarrier(context.command_list, nullptr, 0, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandListAppendExecutionBarrier failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "Execution barrier appended\n";
+
+    context.execute_commandlist_and_sync();
+  }
+
+  std::vector<std::string> available = context.get_kernel_names();
+
+  std::cout << test.title << "\n";
+
+  for (const ComputeKernel &kernel : test.kernels) {
+    if (std::find(available.begin(), available.end(), kernel.name) ==
+        available.end()) {
+      std::cout << kernel.variant << " : skipped, " << kernel.name
+                << " not found in " << test.binary_file << "\n";
+      continue;
+    }
+
+    ze_kernel_handle_t function;
+    if (test.input == ComputeInput::SCALAR) {
+      setup_function(context, function, kernel.name, device_output_buffer,
+                     const_cast<void *>(test.input_value), test.input_size);
+    } else {
+      setup_function(context, function, kernel.name, device_input_value,
+                     device_output_buffer);
+    }
+
+    long double work = static_cast<long double>(number_of_work_items) *
+                       kernel.ops_per_work_item;
+
+    std::cout << kernel.variant << " : ";
+    timed = run_kernel(context, function, workgroup_info, type);
+    gflops = calculate_gbps(timed.mean, work);
+    report_result(context, test.test, kernel.variant, kernel.vector_width,
+                  gflops, "GFLOPS", timed);
+    if (batch_size)
+      report_batched_result(context, function, workgroup_info, test.test,
+                            kernel.variant, kernel.vector_width, work,
+                            "GFLOPS", timed);
+
+    result = zeKernelDestroy(function);
+    if (result) {
+      throw std::runtime_error("zeKernelDestroy failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << kernel.name << " Function Destroyed\n";
+  }
+
+  if (device_input_value) {
+    result = zeMemFree(context.context, device_input_value);
+    if (result) {
+      throw std::runtime_error("zeDriverFreeMem failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "Input Buffer freed\n";
+  }
+
+  result = zeMemFree(context.context, device_output_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Output Buffer freed\n";
+
+  result = zeModuleDestroy(context.module);
+  if (result) {
+    throw std::runtime_error("zeModuleDestroy failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Module destroyed\n";
+
+  print_test_complete();
+}
@@ -8,11 +8,16 @@
 
 #include "../include/ze_peak.h"
 
+#include <algorithm>
+#include <random>
+
 void ZePeak::ze_peak_global_bw(L0Context &context) {
-  long double timed_lo, timed_go, timed, gbps;
+  long double gbps;
+  SampleStatistics timed_lo, timed_go, timed;
   ze_result_t result = ZE_RESULT_SUCCESS;
   uint64_t temp_global_size, max_total_work_items;
   struct ZeWorkGroups workgroup_info;
+  ze_kernel_handle_t fastest;
   TimingMeasurement type = is_bandwidth_with_event_timer();
 
   std::vector<uint8_t> binary_file =
@@ -138,11 +143,18 @@ void ZePeak::ze_peak_global_bw(L0Context &context) {
 
   timed_lo = run_kernel(context, local_offset_v1, workgroup_info, type);
   timed_go = run_kernel(context, global_offset_v1, workgroup_info, type);
-  timed = (timed_lo < timed_go) ? timed_lo : timed_go;
+  timed = (timed_lo.mean < timed_go.mean) ? timed_lo : timed_go;
 
-  gbps = calculate_gbps(timed, numItems * sizeof(float));
+  gbps = calculate_gbps(timed.mean, numItems * sizeof(float));
 
-  std::cout << gbps << " GBPS\n";
+  report_result(context, "global_bw", "float", 1, gbps, "GBPS", timed);
+  if (batch_size) {
+    fastest = (timed_lo.mean < timed_go.mean) ? local_offset_v1
+                                              : global_offset_v1;
+    report_batched_result(context, fastest, workgroup_info, "global_bw",
+                          "float", 1, numItems * sizeof(float), "GBPS",
+                          timed);
+  }
 
   ///////////////////////////////////////////////////////////////////////////
   // Vector width 2
@@ -155,11 +167,18 @@ void ZePeak::ze_peak_global_bw(L0Context &context) {
 
   timed_lo = run_kernel(context, local_offset_v2, workgroup_info, type);
   timed_go = run_kernel(context, global_offset_v2, workgroup_info, type);
-  timed = (timed_lo < timed_go) ? timed_lo : timed_go;
+  timed = (timed_lo.mean < timed_go.mean) ? timed_lo : timed_go;
 
-  gbps = calculate_gbps(timed, numItems * sizeof(float));
+  gbps = calculate_gbps(timed.mean, numItems * sizeof(float));
 
-  std::cout << gbps << " GBPS\n";
+  report_result(context, "global_bw", "float2", 2, gbps, "GBPS", timed);
+  if (batch_size) {
+    fastest = (timed_lo.mean < timed_go.mean) ? local_offset_v2
+                                              : global_offset_v2;
+    report_batched_result(context, fastest, workgroup_info, "global_bw",
+                          "float2", 2, numItems * sizeof(float), "GBPS",
+                          timed);
+  }
 
   ///////////////////////////////////////////////////////////////////////////
   // Vector width 4
@@ -172,11 +191,18 @@ void ZePeak::ze_peak_global_bw(L0Context &context) {
 
   timed_lo = run_kernel(context, local_offset_v4, workgroup_info, type);
   timed_go = run_kernel(context, global_offset_v4, workgroup_info, type);
-  timed = (timed_lo < timed_go) ? timed_lo : timed_go;
+  timed = (timed_lo.mean < timed_go.mean) ? timed_lo : timed_go;
 
-  gbps = calculate_gbps(timed, numItems * sizeof(float));
+  gbps = calculate_gbps(timed.mean, numItems * sizeof(float));
 
-  std::cout << gbps << " GBPS\n";
+  report_result(context, "global_bw", "float4", 4, gbps, "GBPS", timed);
+  if (batch_size) {
+    fastest = (timed_lo.mean < timed_go.mean) ? local_offset_v4
+                                              : global_offset_v4;
+    report_batched_result(context, fastest, workgroup_info, "global_bw",
+                          "float4", 4, numItems * sizeof(float), "GBPS",
+                          timed);
+  }
 
   ///////////////////////////////////////////////////////////////////////////
   // Vector width 8
@@ -189,11 +215,18 @@ void ZePeak::ze_peak_global_bw(L0Context &context) {
 
   timed_lo = run_kernel(context, local_offset_v8, workgroup_info, type);
   timed_go = run_kernel(context, global_offset_v8, workgroup_info, type);
-  timed = (timed_lo < timed_go) ? timed_lo : timed_go;
+  timed = (timed_lo.mean < timed_go.mean) ? timed_lo : timed_go;
 
-  gbps = calculate_gbps(timed, numItems * sizeof(float));
+  gbps = calculate_gbps(timed.mean, numItems * sizeof(float));
 
-  std::cout << gbps << " GBPS\n";
+  report_result(context, "global_bw", "float8", 8, gbps, "GBPS", timed);
+  if (batch_size) {
+    fastest = (timed_lo.mean < timed_go.mean) ? local_offset_v8
+                                              : global_offset_v8;
+    report_batched_result(context, fastest, workgroup_info, "global_bw",
+                          "float8", 8, numItems * sizeof(float), "GBPS",
+                          timed);
+  }
 
   ///////////////////////////////////////////////////////////////////////////
   // Vector width 16
@@ -205,11 +238,20 @@ void ZePeak::ze_peak_global_bw(L0Context &context) {
 
   timed_lo = run_kernel(context, local_offset_v16, workgroup_info, type);
   timed_go = run_kernel(context, global_offset_v16, workgroup_info, type);
-  timed = (timed_lo < timed_go) ? timed_lo : timed_go;
+  timed = (timed_lo.mean < timed_go.mean) ? timed_lo : timed_go;
 
-  gbps = calculate_gbps(timed, numItems * sizeof(float));
+  gbps = calculate_gbps(timed.mean, numItems * sizeof(float));
 
-  std::cout << gbps << " GBPS\n";
+  report_result(context, "global_bw", "float16", 16, gbps, "GBPS", timed);
+  if (batch_size) {
+    fastest = (timed_lo.mean < timed_go.mean) ? local_offset_v16
+                                              : global_offset_v16;
+    report_batched_result(context, fastest, workgroup_info, "global_bw",
+                          "float16", 16, numItems * sizeof(float), "GBPS",
+                          timed);
+  }
+
+  _global_bw_access_patterns(context, inputBuf, outputBuf, numItems);
 
   result = zeKernelDestroy(local_offset_v1);
   if (result) {
@@ -317,3 +359,210 @@ void ZePeak::ze_peak_global_bw(L0Context &context) {
 
   print_test_complete();
 }
+
+//---------------------------------------------------------------------
+// Measures global memory bandwidth for the access patterns of real
+// kernels: strided reads, random gather through an index buffer,
+// write-only, copy and read-modify-write. Bandwidth is calculated from
+// the bytes the kernel asks for, so a pattern that only uses part of
+// every cache line it touches reports less than contiguous reads.
+// Reads of the gather index buffer are not counted. The kernels are
+// loaded from ze_global_bw_patterns.spv, and the sweep is skipped when
+// that binary has not been built.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::_global_bw_access_patterns(L0Context &context, void *input_buffer,
+                                        void *output_buffer,
+                                        uint64_t number_of_items) {
+  static const uint32_t max_stride = 128;
+  static const uint64_t max_gather_indices = 1 << 26;
+  long double gbps;
+  SampleStatistics timed;
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  uint64_t work_items;
+  struct ZeWorkGroups workgroup_info;
+  TimingMeasurement type = is_bandwidth_with_event_timer();
+
+  std::vector<uint8_t> binary_file =
+      context.load_binary_file("ze_global_bw_patterns.spv");
+  if (binary_file.empty()) {
+    std::cout << "Global memory bandwidth by access pattern : skipped, "
+                 "build ze_global_bw_patterns.spv from "
+                 "kernels/ze_global_bw_patterns.cl to run it\n";
+    return;
+  }
+
+  /* The patterns have a module of their own, so that ze_global_bw.spv and
+   * the vector width results do not depend on them */
+  ze_module_handle_t global_bw_module = context.module;
+  context.create_module(binary_file);
+
+  std::vector<std::string> available = context.get_kernel_names();
+
+  /* Kernels missing from an older ze_global_bw_patterns.spv are skipped */
+  auto in_module = [&available](const std::string &kernel_name,
+                                const std::string &variant) {
+    if (std::find(available.begin(), available.end(), kernel_name) !=
+        available.end())
+      return true;
+    std::cout << variant << " : skipped, " << kernel_name
+              << " not found in ze_global_bw_patterns.spv\n";
+    return false;
+  };
+
+  std::cout << "Global memory bandwidth by access pattern (GBPS)\n";
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Strided reads
+  if (in_module("global_bandwidth_strided", "strided")) {
+    ze_kernel_handle_t strided;
+    setup_function(context, strided, "global_bandwidth_strided", input_buffer,
+                   output_buffer);
+
+    for (uint32_t stride = 1; stride <= max_stride; stride *= 2) {
+      uint64_t requested_items = number_of_items / stride / FETCH_PER_WI;
+      if (requested_items == 0)
+        break;
+      work_items = set_workgroups(context, requested_items, &workgroup_info);
+
+      result = zeKernelSetArgumentValue(strided, 2, sizeof(stride), &stride);
+      if (result) {
+        throw std::runtime_error("zeKernelSetArgumentValue failed: " +
+                                 std::to_string(result));
+      }
+
+      std::cout << "stride " << stride << " : ";
+      timed = run_kernel(context, strided, workgroup_info, type);
+      gbps =
+          calculate_gbps(timed.mean, work_items * FETCH_PER_WI * sizeof(float));
+      report_result(context, "global_bw", "stride " + std::to_string(stride), 1,
+                    gbps, "GBPS", timed);
+    }
+
+    result = zeKernelDestroy(strided);
+    if (result) {
+      throw std::runtime_error("zeKernelDestroy failed: " +
+                               std::to_string(result));
+    }
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Random gather
+  if (in_module("global_bandwidth_gather", "random gather")) {
+    uint64_t gather_items = MIN(number_of_items, max_gather_indices);
+    work_items =
+        set_workgroups(context, gather_items / FETCH_PER_WI, &workgroup_info);
+    uint64_t number_of_indices = work_items * FETCH_PER_WI;
+
+    std::vector<uint32_t> indices(static_cast<size_t>(number_of_indices));
+    std::mt19937 generator(0);
+    std::uniform_int_distribution<uint64_t> distribution(0,
+                                                         number_of_items - 1);
+    for (auto &index : indices) {
+      index = static_cast<uint32_t>(distribution(generator));
+    }
+
+    void *index_buffer;
+    ze_device_mem_alloc_desc_t index_device_desc = {};
+    index_device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+    index_device_desc.pNext = nullptr;
+    index_device_desc.ordinal = 0;
+    index_device_desc.flags = 0;
+    result = zeMemAllocDevice(context.context, &index_device_desc,
+                              indices.size() * sizeof(uint32_t), 1,
+                              context.device, &index_buffer);
+    if (result) {
+      throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "index_buffer device buffer allocated\n";
+
+    result = zeCommandListAppendMemoryCopy(
+        context.command_list, index_buffer, indices.data(),
+        indices.size() * sizeof(uint32_t), nullptr, 0, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandListAppendMemoryCopy failed: " +
+                               std::to_string(result));
+    }
+    context.execute_commandlist_and_sync();
+
+    ze_kernel_handle_t gather;
+    setup_function(context, gather, "global_bandwidth_gather", input_buffer,
+                   output_buffer);
+    result = zeKernelSetArgumentValue(gather, 2, sizeof(index_buffer),
+                                      &index_buffer);
+    if (result) {
+      throw std::runtime_error("zeKernelSetArgumentValue failed: " +
+                               std::to_string(result));
+    }
+
+    std::cout << "random gather : ";
+    timed = run_kernel(context, gather, workgroup_info, type);
+    gbps = calculate_gbps(timed.mean, number_of_indices * sizeof(float));
+    report_result(context, "global_bw", "random gather", 1, gbps, "GBPS",
+                  timed);
+
+    result = zeKernelDestroy(gather);
+    if (result) {
+      throw std::runtime_error("zeKernelDestroy failed: " +
+                               std::to_string(result));
+    }
+
+    result = zeMemFree(context.context, index_buffer);
+    if (result) {
+      throw std::runtime_error("zeDriverFreeMem failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "Index Buffer freed\n";
+  }
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Contiguous write-only, copy and read-modify-write
+  struct {
+    const char *kernel_name;
+    const char *variant;
+    uint32_t accesses_per_element;
+  } patterns[] = {
+      {"global_bandwidth_write_only", "write only", 1},
+      {"global_bandwidth_copy", "copy", 2},
+      {"global_bandwidth_read_modify_write", "read modify write", 2},
+  };
+
+  work_items =
+      set_workgroups(context, number_of_items / FETCH_PER_WI, &workgroup_info);
+
+  for (auto &pattern : patterns) {
+    if (!in_module(pattern.kernel_name, pattern.variant))
+      continue;
+
+    ze_kernel_handle_t function;
+    setup_function(context, function, pattern.kernel_name, input_buffer,
+                   output_buffer);
+
+    std::cout << pattern.variant << " : ";
+    timed = run_kernel(context, function, workgroup_info, type);
+    gbps = calculate_gbps(timed.mean, work_items * FETCH_PER_WI *
+                                          pattern.accesses_per_element *
+                                          sizeof(float));
+    report_result(context, "global_bw", pattern.variant, 1, gbps, "GBPS",
+                  timed);
+
+    result = zeKernelDestroy(function);
+    if (result) {
+      throw std::runtime_error("zeKernelDestroy failed: " +
+                               std::to_string(result));
+    }
+  }
+
+  result = zeModuleDestroy(context.module);
+  if (result) {
+    throw std::runtime_error("zeModuleDestroy failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Access pattern module destroyed\n";
+  context.module = global_bw_module;
+}
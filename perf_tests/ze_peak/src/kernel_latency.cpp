@@ -8,13 +8,16 @@
 
 #include "../include/ze_peak.h"
 
+#include <algorithm>
+#include <iomanip>
+
 void ZePeak::ze_peak_kernel_latency(L0Context &context) {
   uint64_t num_items = get_max_work_items(context) * FETCH_PER_WI;
   uint64_t global_size = (num_items / FETCH_PER_WI);
 
   struct ZeWorkGroups workgroup_info;
   set_workgroups(context, global_size, &workgroup_info);
-  long double latency = 0;
+  SampleStatistics latency;
   ze_result_t result = ZE_RESULT_SUCCESS;
 
   std::vector<uint8_t> binary_file =
@@ -64,13 +67,39 @@ void ZePeak::ze_peak_kernel_latency(L0Context &context) {
   std::cout << "Kernel launch latency : ";
   latency = run_kernel(context, local_offset_v1, workgroup_info,
                        TimingMeasurement::KERNEL_LAUNCH_LATENCY, true);
-  std::cout << latency << " (uS)\n";
+  report_result(context, "kernel_lat", "launch_latency", 1, latency.mean,
+                "uS", latency);
 
   ///////////////////////////////////////////////////////////////////////////
   std::cout << "Kernel duration : ";
   latency = run_kernel(context, local_offset_v1, workgroup_info,
-                       TimingMeasurement::KERNEL_COMPLETE_RUNTIME, false);
-  std::cout << latency << " (uS)\n";
+                       TimingMeasurement::KERNEL_COMPLETE_RUNTIME, true);
+  report_result(context, "kernel_lat", "duration", 1, latency.mean, "uS",
+                latency);
+
+  ///////////////////////////////////////////////////////////////////////////
+  // Launch to completion latency distribution
+  struct {
+    LatencyMode mode;
+    const char *variant;
+  } latency_modes[] = {
+      {LatencyMode::QUEUE_SYNCHRONIZE, "queue, queue synchronize"},
+      {LatencyMode::QUEUE_EVENT, "queue, event synchronize"},
+      {LatencyMode::IMMEDIATE_ASYNC_EVENT,
+       "async immediate, event synchronize"},
+      {LatencyMode::IMMEDIATE_SYNCHRONOUS, "sync immediate"},
+  };
+
+  std::cout << "Launch to completion latency distribution\n";
+  for (auto &latency_mode : latency_modes) {
+    std::cout << latency_mode.variant << " : ";
+    SampleCollector samples = _measure_launch_to_completion(
+        context, local_offset_v1, workgroup_info, latency_mode.mode);
+    latency = samples.statistics();
+    report_result(context, "kernel_lat", latency_mode.variant, 1, latency.mean,
+                  "uS", latency);
+    _print_latency_histogram(samples);
+  }
 
   result = zeKernelDestroy(local_offset_v1);
   if (result) {
@@ -106,3 +135,170 @@ void ZePeak::ze_peak_kernel_latency(L0Context &context) {
 
   print_test_complete();
 }
+
+//---------------------------------------------------------------------
+// Utility function to measure latency_iters times how long it takes from
+// the submission of a kernel to the host seeing its completion, for one
+// way of submitting the kernel and of waiting for it:
+//          QUEUE_SYNCHRONIZE - Regular command list, zeCommandQueueSynchronize
+//                QUEUE_EVENT - Regular command list, zeEventHostSynchronize
+//      IMMEDIATE_ASYNC_EVENT - Asynchronous immediate command list,
+//                              zeEventHostSynchronize
+//      IMMEDIATE_SYNCHRONOUS - Synchronous immediate command list, the
+//                              append returns once the kernel is done
+// On success, the samples in microseconds are returned.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+SampleCollector ZePeak::_measure_launch_to_completion(
+    L0Context &context, ze_kernel_handle_t &function,
+    struct ZeWorkGroups &workgroup_info, LatencyMode mode) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  ze_command_list_handle_t command_list = context.command_list;
+  ze_event_pool_handle_t event_pool;
+  ze_event_handle_t event;
+  SampleCollector samples;
+  Timer timer;
+
+  bool immediate = (mode == LatencyMode::IMMEDIATE_ASYNC_EVENT) ||
+                   (mode == LatencyMode::IMMEDIATE_SYNCHRONOUS);
+  bool use_event = (mode == LatencyMode::QUEUE_EVENT) ||
+                   (mode == LatencyMode::IMMEDIATE_ASYNC_EVENT);
+
+  result = zeKernelSetGroupSize(function, workgroup_info.group_size_x,
+                                workgroup_info.group_size_y,
+                                workgroup_info.group_size_z);
+  if (result) {
+    throw std::runtime_error("zeKernelSetGroupSize failed: " +
+                             std::to_string(result));
+  }
+
+  single_event_pool_create(context, &event_pool,
+                           ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  single_event_create(event_pool, &event);
+  ze_event_handle_t signal_event = use_event ? event : nullptr;
+
+  if (immediate) {
+    ze_command_queue_desc_t command_queue_description = {};
+    command_queue_description.stype = ZE_STRUCTURE_TYPE_COMMAND_QUEUE_DESC;
+    command_queue_description.pNext = nullptr;
+    command_queue_description.ordinal = context.command_queue_id;
+    command_queue_description.mode =
+        (mode == LatencyMode::IMMEDIATE_SYNCHRONOUS)
+            ? ZE_COMMAND_QUEUE_MODE_SYNCHRONOUS
+            : ZE_COMMAND_QUEUE_MODE_ASYNCHRONOUS;
+
+    result = zeCommandListCreateImmediate(context.context, context.device,
+                                          &command_queue_description,
+                                          &command_list);
+    if (result) {
+      throw std::runtime_error("zeCommandListCreateImmediate failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "Immediate command list created\n";
+  } else {
+    result = zeCommandListAppendLaunchKernel(
+        command_list, function, &workgroup_info.thread_group_dimensions,
+        signal_event, 0, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandListAppendLaunchKernel failed: " +
+                               std::to_string(result));
+    }
+
+    result = zeCommandListClose(command_list);
+    if (result) {
+      throw std::runtime_error("zeCommandListClose failed: " +
+                               std::to_string(result));
+    }
+  }
+
+  samples.reserve(latency_iters);
+  for (uint32_t i = 0; i < warmup_iterations + latency_iters; i++) {
+    timer.start();
+    if (immediate) {
+      result = zeCommandListAppendLaunchKernel(
+          command_list, function, &workgroup_info.thread_group_dimensions,
+          signal_event, 0, nullptr);
+      if (result) {
+        throw std::runtime_error("zeCommandListAppendLaunchKernel failed: " +
+                                 std::to_string(result));
+      }
+    } else {
+      run_command_queue(context);
+    }
+
+    if (use_event) {
+      result = zeEventHostSynchronize(event, UINT64_MAX);
+      if (result) {
+        throw std::runtime_error("zeEventHostSynchronize failed: " +
+                                 std::to_string(result));
+      }
+    } else if (!immediate) {
+      synchronize_command_queue(context);
+    }
+    long double elapsed = timer.stopAndTime();
+
+    if (i >= warmup_iterations)
+      samples.add(elapsed);
+
+    if (use_event) {
+      if (!immediate)
+        synchronize_command_queue(context);
+
+      result = zeEventHostReset(event);
+      if (result) {
+        throw std::runtime_error("zeEventHostReset failed: " +
+                                 std::to_string(result));
+      }
+    }
+  }
+
+  if (immediate) {
+    result = zeCommandListDestroy(command_list);
+    if (result) {
+      throw std::runtime_error("zeCommandListDestroy failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "Immediate command list destroyed\n";
+  } else {
+    context.reset_commandlist(command_list);
+  }
+
+  zeEventDestroy(event);
+  zeEventPoolDestroy(event_pool);
+
+  return samples;
+}
+
+//---------------------------------------------------------------------
+// Utility function to print the tail percentiles of a set of latency
+// samples, and a histogram of the samples in power-of-two buckets.
+//---------------------------------------------------------------------
+void ZePeak::_print_latency_histogram(const SampleCollector &samples) {
+  static const size_t bar_width = 40;
+  SampleStatistics stats = samples.statistics();
+  std::vector<size_t> buckets = samples.log2_histogram();
+
+  std::cout << "    [uS] p50 " << stats.median << " p99 " << stats.p99
+            << " p99.9 " << stats.p999 << "\n";
+
+  size_t largest = 0;
+  size_t first = buckets.size();
+  for (size_t i = 0; i < buckets.size(); i++) {
+    largest = std::max(largest, buckets[i]);
+    if (buckets[i] && (first == buckets.size()))
+      first = i;
+  }
+
+  for (size_t i = first; i < buckets.size(); i++) {
+    uint64_t lower = (i == 0) ? 0 : (uint64_t(1) << (i - 1));
+    uint64_t upper = uint64_t(1) << i;
+    size_t bar = largest ? (buckets[i] * bar_width + largest - 1) / largest : 0;
+
+    std::cout << "    [uS] " << std::setw(7) << lower << " - " << std::setw(7)
+              << upper << " | " << std::string(bar, '#')
+              << std::string(bar_width - bar, ' ') << " " << buckets[i]
+              << "\n";
+  }
+}
@@ -0,0 +1,176 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "../include/ze_peak.h"
+
+#include <atomic>
+#include <cstdio>
+#include <iomanip>
+#include <sstream>
+
+#if defined(unix) || defined(__unix__) || defined(__unix)
+#include <unistd.h>
+static unsigned long process_id() {
+  return static_cast<unsigned long>(getpid());
+}
+#endif
+
+#if defined(_WIN64) || defined(_WIN32)
+#include <process.h>
+static unsigned long process_id() {
+  return static_cast<unsigned long>(_getpid());
+}
+#endif
+
+//---------------------------------------------------------------------
+// 64 bit FNV-1a hash, used to tell SPIR-V binaries apart in the cache.
+//---------------------------------------------------------------------
+static uint64_t fnv1a_hash(const std::vector<uint8_t> &data) {
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (uint8_t byte : data) {
+    hash ^= byte;
+    hash *= 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+void ModuleLoadStatistics::add(const ModuleLoadStatistics &other) {
+  modules += other.modules;
+  cache_hits += other.cache_hits;
+  time_us += other.time_us;
+}
+
+//---------------------------------------------------------------------
+// Utility function to build the path of the cached native binary of a
+// SPIR-V module. The native binary depends on the SPIR-V, on the device
+// and on the driver, so the file name is made of the hash of the SPIR-V,
+// the device UUID and the driver version.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+std::string
+L0Context::module_cache_path(const std::vector<uint8_t> &binary_file) {
+  ze_driver_properties_t driver_properties = {};
+  driver_properties.stype = ZE_STRUCTURE_TYPE_DRIVER_PROPERTIES;
+  driver_properties.pNext = nullptr;
+  ze_result_t result = zeDriverGetProperties(driver, &driver_properties);
+  if (result) {
+    throw std::runtime_error("zeDriverGetProperties failed: " +
+                             std::to_string(result));
+  }
+
+  std::stringstream path;
+  path << module_cache_dir << "/" << std::hex << std::setfill('0')
+       << std::setw(16) << fnv1a_hash(binary_file) << "-"
+       << device_uuid_to_string(device_property.uuid) << "-" << std::setw(8)
+       << driver_properties.driverVersion << ".bin";
+  return path.str();
+}
+
+//---------------------------------------------------------------------
+// Utility function to create the module from the native binary cached
+// at cache_path. Returns false if there is no such binary, or if the
+// driver rejects it, in which case the module has to be built from
+// SPIR-V.
+//---------------------------------------------------------------------
+bool L0Context::create_module_from_cache(const std::string &cache_path) {
+  std::ifstream stream(cache_path, std::ios::in | std::ios::binary);
+  if (!stream.good())
+    return false;
+
+  std::vector<uint8_t> native_binary(
+      (std::istreambuf_iterator<char>(stream)),
+      std::istreambuf_iterator<char>());
+  if (native_binary.empty())
+    return false;
+
+  ze_module_desc_t module_description = {};
+  module_description.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
+
+  module_description.pNext = nullptr;
+  module_description.format = ZE_MODULE_FORMAT_NATIVE;
+  module_description.inputSize = static_cast<uint32_t>(native_binary.size());
+  module_description.pInputModule = native_binary.data();
+  module_description.pBuildFlags = nullptr;
+
+  ze_result_t result =
+      zeModuleCreate(context, device, &module_description, &module, nullptr);
+  if (result) {
+    std::cerr << "Ignoring cached module " << cache_path
+              << ", zeModuleCreate failed: " << result << "\n";
+    return false;
+  }
+  if (verbose)
+    std::cout << "Module created from " << cache_path << "\n";
+
+  return true;
+}
+
+//---------------------------------------------------------------------
+// Utility function to save the native binary of the current module to
+// cache_path. The binary is written to a temporary file first and then
+// renamed, so that concurrent runs sharing the cache never read a
+// partial file. The temporary file name is unique to this process and
+// save, so that two runs saving the same module never write the same
+// temporary file. Failing to write the cache is not an error.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void L0Context::save_module_to_cache(const std::string &cache_path) {
+  size_t size = 0;
+  ze_result_t result = zeModuleGetNativeBinary(module, &size, nullptr);
+  if (result) {
+    throw std::runtime_error("zeModuleGetNativeBinary failed: " +
+                             std::to_string(result));
+  }
+
+  std::vector<uint8_t> native_binary(size);
+  result = zeModuleGetNativeBinary(module, &size, native_binary.data());
+  if (result) {
+    throw std::runtime_error("zeModuleGetNativeBinary failed: " +
+                             std::to_string(result));
+  }
+
+  static std::atomic<unsigned> saves(0);
+  std::string temporary_path = cache_path + "." +
+                               std::to_string(process_id()) + "." +
+                               std::to_string(saves++) + ".tmp";
+  std::ofstream stream(temporary_path,
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  if (stream.good()) {
+    stream.write(reinterpret_cast<const char *>(native_binary.data()),
+                 native_binary.size());
+    stream.close();
+  }
+  if (!stream.good() ||
+      std::rename(temporary_path.c_str(), cache_path.c_str())) {
+    std::cerr << "Failed to write module cache file: " << cache_path << "\n";
+    std::remove(temporary_path.c_str());
+    return;
+  }
+  if (verbose)
+    std::cout << "Module saved to " << cache_path << "\n";
+}
+
+//---------------------------------------------------------------------
+// Utility function to print the time spent creating modules. A run with
+// no module from the cache shows the cold startup cost, and a run with
+// every module from the cache the warm one.
+//---------------------------------------------------------------------
+void ZePeak::print_module_loads(const ModuleLoadStatistics &module_loads) {
+  if (!module_loads.modules)
+    return;
+
+  std::cout << "Module creation : " << module_loads.time_us / 1000
+            << " ms for " << module_loads.modules << " module(s)";
+  if (!module_cache_dir.empty()) {
+    std::cout << ", " << module_loads.cache_hits << " from cache ("
+              << ((module_loads.cache_hits == module_loads.modules) ? "warm"
+                                                                     : "cold")
+              << " start)";
+  }
+  std::cout << "\n";
+}
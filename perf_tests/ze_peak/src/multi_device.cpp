@@ -0,0 +1,385 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "../include/ze_peak.h"
+
+#include <atomic>
+#include <exception>
+#include <thread>
+
+//---------------------------------------------------------------------
+// Runs the selected tests on every device of the driver and on each of
+// their sub-devices in turn. All devices share the driver and context
+// of root_context.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::ze_peak_all_devices(L0Context &root_context) {
+  std::vector<ze_device_handle_t> devices = root_context.get_devices(true);
+
+  for (size_t i = 0; i < devices.size(); i++) {
+    std::cout << "==== Device " << i << " of " << devices.size()
+              << " ====\n";
+
+    L0Context device_context;
+    device_context.verbose = verbose;
+    device_context.init_xe(root_context, devices[i]);
+    results.add_device(device_context.device_property);
+
+    run_selected_tests(device_context);
+
+    root_context.module_loads.add(device_context.module_loads);
+    device_context.clean_xe();
+  }
+}
+
+//---------------------------------------------------------------------
+// Runs global_bw and sp_compute on all tiles at once. The tiles are the
+// sub-devices of the selected device, or every device of the driver if
+// the selected device has no sub-devices. Each tile is first measured
+// alone, then all tiles are measured together and the aggregate is
+// compared with the sum of the solo numbers. Other selected tests are
+// not run.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::ze_peak_concurrent(L0Context &root_context) {
+  std::vector<ze_device_handle_t> devices =
+      root_context.get_sub_devices(root_context.device);
+  if (devices.size() == 0)
+    devices = root_context.get_devices(false);
+
+  std::vector<L0Context> tiles(devices.size());
+  for (size_t i = 0; i < devices.size(); i++) {
+    tiles[i].verbose = verbose;
+    tiles[i].init_xe(root_context, devices[i]);
+    results.add_device(tiles[i].device_property);
+  }
+  std::cout << "Running concurrently on " << tiles.size() << " tile(s)\n";
+  if (run_hp_compute || run_dp_compute || run_int_compute || run_transfer_bw ||
+      run_kernel_lat || run_working_set || run_overlap) {
+    std::cout << "Only global_bw and sp_compute run with --concurrent, the "
+                 "other selected tests are skipped\n";
+  }
+
+  std::vector<TileWorkload> workloads(tiles.size());
+
+  if (run_global_bw) {
+    for (size_t i = 0; i < tiles.size(); i++)
+      _setup_tile_global_bw(tiles[i], workloads[i]);
+
+    std::cout << "Concurrent global memory bandwidth (GBPS)\n";
+    _run_tiles_concurrently(tiles, workloads, "global_bw", "GBPS");
+
+    for (size_t i = 0; i < tiles.size(); i++)
+      _release_tile_workload(tiles[i], workloads[i]);
+  }
+
+  if (run_sp_compute) {
+    for (size_t i = 0; i < tiles.size(); i++)
+      _setup_tile_sp_compute(tiles[i], workloads[i]);
+
+    std::cout << "Concurrent single precision compute (GFLOPS)\n";
+    _run_tiles_concurrently(tiles, workloads, "sp_compute", "GFLOPS");
+
+    for (size_t i = 0; i < tiles.size(); i++)
+      _release_tile_workload(tiles[i], workloads[i]);
+  }
+
+  for (auto &tile : tiles) {
+    root_context.module_loads.add(tile.module_loads);
+    tile.clean_xe();
+  }
+}
+
+//---------------------------------------------------------------------
+// Utility function to measure every workload alone on its tile, and then
+// all of them at the same time with one host thread per tile.
+// Every tile submits the same # iterations back to back in both runs,
+// timed on the host, so that solo and concurrent numbers use the same
+// timing source. The aggregate is the work of all the tiles divided by
+// the overlapped window, from the first tile starting to the last one
+// finishing, so a tile that finishes early does not inflate it.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::_run_tiles_concurrently(std::vector<L0Context> &tiles,
+                                     std::vector<TileWorkload> &workloads,
+                                     const std::string &test,
+                                     const std::string &units) {
+  long double solo_total = 0;
+  long double total_work = 0;
+  long double value;
+
+  for (size_t i = 0; i < tiles.size(); i++) {
+    std::cout << "tile " << i << " alone : ";
+    SampleStatistics timed =
+        run_kernel(tiles[i], workloads[i].kernel, workloads[i].workgroup_info,
+                   TimingMeasurement::BANDWIDTH);
+    value = calculate_gbps(timed.mean, workloads[i].work_per_launch);
+    solo_total += value;
+    report_result(tiles[i], test, "tile " + std::to_string(i) + " alone", 4,
+                  value, units, timed);
+  }
+
+  std::vector<Timer> timers(tiles.size());
+  std::vector<long double> elapsed(tiles.size());
+  std::vector<std::exception_ptr> errors(tiles.size());
+  std::atomic<size_t> ready(0);
+  std::vector<std::thread> threads;
+
+  for (size_t i = 0; i < tiles.size(); i++) {
+    threads.emplace_back([&, i]() {
+      try {
+        L0Context &tile = tiles[i];
+        TileWorkload &workload = workloads[i];
+
+        ze_result_t result = zeKernelSetGroupSize(
+            workload.kernel, workload.workgroup_info.group_size_x,
+            workload.workgroup_info.group_size_y,
+            workload.workgroup_info.group_size_z);
+        if (result) {
+          throw std::runtime_error("zeKernelSetGroupSize failed: " +
+                                   std::to_string(result));
+        }
+
+        result = zeCommandListAppendLaunchKernel(
+            tile.command_list, workload.kernel,
+            &workload.workgroup_info.thread_group_dimensions, nullptr, 0,
+            nullptr);
+        if (result) {
+          throw std::runtime_error("zeCommandListAppendLaunchKernel failed: " +
+                                   std::to_string(result));
+        }
+
+        result = zeCommandListClose(tile.command_list);
+        if (result) {
+          throw std::runtime_error("zeCommandListClose failed: " +
+                                   std::to_string(result));
+        }
+
+        for (uint32_t j = 0; j < warmup_iterations; j++) {
+          run_command_queue(tile);
+        }
+        synchronize_command_queue(tile);
+
+        /* Start all the tiles together */
+        ready++;
+        while (ready.load() < tiles.size())
+          std::this_thread::yield();
+
+        timers[i].start();
+        for (uint32_t j = 0; j < iters; j++) {
+          run_command_queue(tile);
+        }
+        synchronize_command_queue(tile);
+        elapsed[i] = timers[i].stopAndTime();
+
+        tile.reset_commandlist(tile.command_list);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto &thread : threads)
+    thread.join();
+  for (auto &error : errors) {
+    if (error)
+      std::rethrow_exception(error);
+  }
+
+  for (size_t i = 0; i < tiles.size(); i++) {
+    std::cout << "tile " << i << " concurrent : ";
+    SampleStatistics timed;
+    timed.mean = elapsed[i] / iters;
+    value = calculate_gbps(timed.mean, workloads[i].work_per_launch);
+    total_work += workloads[i].work_per_launch * iters;
+    report_result(tiles[i], test, "tile " + std::to_string(i) + " concurrent",
+                  4, value, units, timed);
+  }
+
+  auto window_start = timers[0].tick;
+  auto window_end = timers[0].tock;
+  for (auto &timer : timers) {
+    if (timer.tick < window_start)
+      window_start = timer.tick;
+    if (timer.tock > window_end)
+      window_end = timer.tock;
+  }
+  long double window =
+      std::chrono::duration<long double, std::chrono::microseconds::period>(
+          window_end - window_start)
+          .count();
+  long double aggregate = calculate_gbps(window, total_work);
+
+  std::cout << "aggregate : ";
+  SampleStatistics timed;
+  timed.mean = window / iters;
+  report_result(tiles[0], test, "aggregate", 4, aggregate, units, timed);
+  std::cout << "sum of tiles alone : " << solo_total << " " << units << "\n";
+  if (solo_total > 0) {
+    std::cout << "scaling efficiency : " << aggregate / solo_total * 100
+              << " %\n";
+  }
+
+  print_test_complete();
+}
+
+//---------------------------------------------------------------------
+// Utility function to set up the float4 global bandwidth kernel on a
+// tile, sized the same way as in ze_peak_global_bw.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::_setup_tile_global_bw(L0Context &context,
+                                   TileWorkload &workload) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+
+  std::vector<uint8_t> binary_file =
+      context.load_binary_file("ze_global_bw.spv");
+
+  context.create_module(binary_file);
+
+  uint64_t maxItems =
+      context.device_property.maxMemAllocSize / sizeof(float) / 2;
+  uint64_t numItems = roundToMultipleOf(
+      maxItems,
+      (context.device_compute_property.maxGroupSizeX * FETCH_PER_WI * 16),
+      global_bw_max_size);
+
+  numItems = set_workgroups(context, numItems, &workload.workgroup_info);
+
+  ze_device_mem_alloc_desc_t device_desc = {};
+  device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+  device_desc.pNext = nullptr;
+  device_desc.ordinal = 0;
+  device_desc.flags = 0;
+
+  result = zeMemAllocDevice(context.context, &device_desc,
+                            static_cast<size_t>((numItems * sizeof(float))), 1,
+                            context.device, &workload.input);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  result = zeMemAllocDevice(context.context, &device_desc,
+                            static_cast<size_t>((numItems * sizeof(float))), 1,
+                            context.device, &workload.output);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Tile buffers allocated\n";
+
+  setup_function(context, workload.kernel, "global_bandwidth_v4_local_offset",
+                 workload.input, workload.output);
+
+  set_workgroups(context, numItems / 4 / FETCH_PER_WI,
+                 &workload.workgroup_info);
+  workload.work_per_launch = numItems * sizeof(float);
+}
+
+//---------------------------------------------------------------------
+// Utility function to set up the float4 single precision compute kernel
+// on a tile, sized the same way as in ze_peak_sp_compute.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::_setup_tile_sp_compute(L0Context &context,
+                                    TileWorkload &workload) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  float flops_per_work_item = 4096;
+  float input_value = 1.3f;
+
+  std::vector<uint8_t> binary_file =
+      context.load_binary_file("ze_sp_compute.spv");
+
+  context.create_module(binary_file);
+
+  uint64_t max_work_items =
+      get_max_work_items(context) * 2048; // same multiplier in clPeak
+
+  uint64_t max_number_of_allocated_items =
+      context.device_property.maxMemAllocSize / sizeof(float);
+  uint64_t number_of_work_items =
+      MIN(max_number_of_allocated_items, (max_work_items * sizeof(float)));
+
+  number_of_work_items =
+      set_workgroups(context, number_of_work_items, &workload.workgroup_info);
+
+  ze_device_mem_alloc_desc_t device_desc = {};
+  device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+  device_desc.pNext = nullptr;
+  device_desc.ordinal = 0;
+  device_desc.flags = 0;
+
+  result = zeMemAllocDevice(context.context, &device_desc, sizeof(float), 1,
+                            context.device, &workload.input);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  result = zeMemAllocDevice(
+      context.context, &device_desc,
+      static_cast<size_t>((number_of_work_items * sizeof(float))), 1,
+      context.device, &workload.output);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Tile buffers allocated\n";
+
+  result = zeCommandListAppendMemoryCopy(context.command_list, workload.input,
+                                         &input_value, sizeof(float), nullptr,
+                                         0, nullptr);
+  if (result) {
+    throw std::runtime_error("zeCommandListAppendMemoryCopy failed: " +
+                             std::to_string(result));
+  }
+  context.execute_commandlist_and_sync();
+
+  setup_function(context, workload.kernel, "compute_sp_v4", workload.input,
+                 workload.output);
+
+  workload.work_per_launch = number_of_work_items * flops_per_work_item;
+}
+
+//---------------------------------------------------------------------
+// Utility function to destroy the kernel, buffers and module of a tile
+// workload.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::_release_tile_workload(L0Context &context,
+                                    TileWorkload &workload) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+
+  result = zeKernelDestroy(workload.kernel);
+  if (result) {
+    throw std::runtime_error("zeKernelDestroy failed: " +
+                             std::to_string(result));
+  }
+
+  result = zeMemFree(context.context, workload.input);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+
+  result = zeMemFree(context.context, workload.output);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+
+  result = zeModuleDestroy(context.module);
+  if (result) {
+    throw std::runtime_error("zeModuleDestroy failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Tile workload released\n";
+
+  workload = TileWorkload();
+}
@@ -17,6 +17,8 @@ static const char *usage_str =
     "\n  -e                          time using ze events instead of std "
     "chrono timer"
     "\n                              hide driver latencies [default: No]"
+    "\n                              and report host time, device time and "
+    "the gap"
     "\n  -t, string                  selectively run a particular test"
     "\n      global_bw               selectively run global bandwidth test"
     "\n      hp_compute              selectively run half precision compute "
@@ -28,12 +30,60 @@ static const char *usage_str =
     "\n      int_compute             selectively run integer compute test"
     "\n      transfer_bw             selectively run transfer bandwidth test"
     "\n      kernel_lat              selectively run kernel latency test"
-    "\n  -a                          run all above tests [default]"
+    "\n      working_set             run working set bandwidth sweep, not run "
+    "by"
+    "\n                              default or with -a"
+    "\n      overlap                 selectively run compute and copy overlap "
+    "test"
+    "\n  -a                          run all above tests except "
+    "working_set [default]"
     "\n  -v                          enable verbose prints"
     "\n  -i                          set number of iterations to run[default: "
     "50]"
     "\n  -w                          set number of warmup iterations to "
     "run[default: 10]"
+    "\n  -c, --confidence pct        auto-iteration: after -i iterations keep "
+    "sampling"
+    "\n                              until the 95% confidence interval is "
+    "within"
+    "\n                              pct percent of the mean [default: off]"
+    "\n  --max-iters num             upper bound on iterations in "
+    "auto-iteration mode"
+    "\n                              [default: 1000]"
+    "\n  --latency-iters num         set number of samples per mode in the "
+    "kernel"
+    "\n                              latency distribution [default: 10000]"
+    "\n  --pipeline                  also run transfer_bw with the copy split "
+    "into"
+    "\n                              chunks over the compute and copy engines"
+    "\n  --batch num                 also run global_bw and compute kernels "
+    "with num"
+    "\n                              launches per command list and report the "
+    "gap"
+    "\n                              against one launch per submit "
+    "[default: off]"
+    "\n  --batch-barriers            separate the launches of a batch with "
+    "barriers"
+    "\n  --all-devices               run the selected tests on every device "
+    "and"
+    "\n                              sub-device in turn"
+    "\n  --concurrent                run global_bw and sp_compute on all tiles "
+    "at"
+    "\n                              once and report the aggregate next to "
+    "the"
+    "\n                              per-tile numbers; other tests are not "
+    "run"
+    "\n  --module-cache dir          cache the native binaries of the kernels "
+    "in dir,"
+    "\n                              an existing directory, to skip their "
+    "compilation"
+    "\n                              on later runs [default: off]"
+    "\n  --sysman                    sample power, frequency and temperature "
+    "with"
+    "\n                              Sysman and report results per watt and "
+    "per MHz"
+    "\n  --json file                 write all results to file as JSON"
+    "\n  --csv file                  write all results to file as CSV"
     "\n  -h, --help                  display help message"
     "\n";
 
@@ -49,6 +99,15 @@ static uint32_t sanitize_ulong(char *in) {
   return 0;
 }
 
+static long double sanitize_percentage(char *in) {
+  long double temp = strtold(in, NULL);
+  if (ERANGE == errno || temp < 0 || temp > 100) {
+    fprintf(stderr, "%s is not a valid percentage\n", in);
+    return 0;
+  }
+  return temp;
+}
+
 //---------------------------------------------------------------------
 // Utility function which parses the arguments to ze_peak and
 // sets the test parameters accordingly for main to execute the tests
@@ -85,6 +144,52 @@ int ZePeak::parse_arguments(int argc, char **argv) {
         warmup_iterations = sanitize_ulong(argv[i + 1]);
         i++;
       }
+    } else if ((strcmp(argv[i], "-c") == 0) ||
+               (strcmp(argv[i], "--confidence") == 0)) {
+      if ((i + 1) < argc) {
+        confidence_target = sanitize_percentage(argv[i + 1]) / 100;
+        i++;
+      }
+    } else if (strcmp(argv[i], "--max-iters") == 0) {
+      if ((i + 1) < argc) {
+        max_iters = sanitize_ulong(argv[i + 1]);
+        i++;
+      }
+    } else if (strcmp(argv[i], "--latency-iters") == 0) {
+      if ((i + 1) < argc) {
+        latency_iters = sanitize_ulong(argv[i + 1]);
+        i++;
+      }
+    } else if (strcmp(argv[i], "--pipeline") == 0) {
+      run_pipelined_transfer = true;
+    } else if (strcmp(argv[i], "--batch") == 0) {
+      if ((i + 1) < argc) {
+        batch_size = sanitize_ulong(argv[i + 1]);
+        i++;
+      }
+    } else if (strcmp(argv[i], "--batch-barriers") == 0) {
+      batch_barriers = true;
+    } else if (strcmp(argv[i], "--all-devices") == 0) {
+      run_all_devices = true;
+    } else if (strcmp(argv[i], "--concurrent") == 0) {
+      run_concurrent = true;
+    } else if (strcmp(argv[i], "--module-cache") == 0) {
+      if ((i + 1) < argc) {
+        module_cache_dir = argv[i + 1];
+        i++;
+      }
+    } else if (strcmp(argv[i], "--sysman") == 0) {
+      use_sysman = true;
+    } else if (strcmp(argv[i], "--json") == 0) {
+      if ((i + 1) < argc) {
+        results.json_file_name = argv[i + 1];
+        i++;
+      }
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      if ((i + 1) < argc) {
+        results.csv_file_name = argv[i + 1];
+        i++;
+      }
     } else if ((strcmp(argv[i], "-t") == 0)) {
       run_global_bw = false;
       run_hp_compute = false;
@@ -93,6 +198,8 @@ int ZePeak::parse_arguments(int argc, char **argv) {
       run_int_compute = false;
       run_transfer_bw = false;
       run_kernel_lat = false;
+      run_working_set = false;
+      run_overlap = false;
       if ((i + 1) >= argc) {
         std::cout << usage_str;
         exit(-1);
@@ -118,13 +225,20 @@ int ZePeak::parse_arguments(int argc, char **argv) {
       } else if (strcmp(argv[i + 1], "kernel_lat") == 0) {
         run_kernel_lat = true;
         i++;
+      } else if (strcmp(argv[i + 1], "working_set") == 0) {
+        run_working_set = true;
+        i++;
+      } else if (strcmp(argv[i + 1], "overlap") == 0) {
+        run_overlap = true;
+        i++;
       } else {
         std::cout << usage_str;
         exit(-1);
       }
     } else if (strcmp(argv[i], "-a") == 0) {
       run_global_bw = run_hp_compute = run_sp_compute = run_dp_compute =
-          run_int_compute = run_transfer_bw = run_kernel_lat = true;
+          run_int_compute = run_transfer_bw = run_kernel_lat = run_overlap =
+              true;
     } else {
       std::cout << usage_str;
       exit(-1);
@@ -0,0 +1,326 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "../include/ze_peak.h"
+
+#include <algorithm>
+
+/* Each stream is sized to run for about this many launches of the slower */
+static const uint32_t overlap_stream_length = 20;
+
+//---------------------------------------------------------------------
+// Utility function to append count launches of a kernel, or count copies
+// alternating between host to device and device to host, to a command
+// list. The last command signals last_event.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+static void append_stream(ze_command_list_handle_t command_list,
+                          TileWorkload *workload, void *host_buffer,
+                          void *device_buffer, size_t buffer_size,
+                          uint32_t count, ze_event_handle_t last_event) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+
+  for (uint32_t i = 0; i < count; i++) {
+    ze_event_handle_t event = (i == count - 1) ? last_event : nullptr;
+    if (workload) {
+      result = zeCommandListAppendLaunchKernel(
+          command_list, workload->kernel,
+          &workload->workgroup_info.thread_group_dimensions, event, 0,
+          nullptr);
+      if (result) {
+        throw std::runtime_error("zeCommandListAppendLaunchKernel failed: " +
+                                 std::to_string(result));
+      }
+    } else {
+      void *destination = (i % 2) ? host_buffer : device_buffer;
+      void *source = (i % 2) ? device_buffer : host_buffer;
+      result = zeCommandListAppendMemoryCopy(command_list, destination, source,
+                                             buffer_size, event, 0, nullptr);
+      if (result) {
+        throw std::runtime_error("zeCommandListAppendMemoryCopy failed: " +
+                                 std::to_string(result));
+      }
+    }
+  }
+
+  result = zeCommandListClose(command_list);
+  if (result) {
+    throw std::runtime_error("zeCommandListClose failed: " +
+                             std::to_string(result));
+  }
+}
+
+//---------------------------------------------------------------------
+// Utility function to submit the compute and/or the copy command list,
+// and to return how long after the submission each of them completed.
+// Completion is detected by polling the event signaled by the last
+// command of each list, so both times are taken on the same host clock.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+static void run_streams(L0Context &context, bool run_compute, bool run_copy,
+                        ze_event_handle_t compute_event,
+                        ze_event_handle_t copy_event,
+                        long double &compute_time, long double &copy_time) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  Timer timer;
+  bool compute_done = !run_compute;
+  bool copy_done = !run_copy;
+
+  timer.start();
+  if (run_compute) {
+    result = zeCommandQueueExecuteCommandLists(
+        context.command_queue, 1, &context.command_list, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandQueueExecuteCommandLists failed: " +
+                               std::to_string(result));
+    }
+  }
+  if (run_copy) {
+    result = zeCommandQueueExecuteCommandLists(
+        context.copy_command_queue, 1, &context.copy_command_list, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandQueueExecuteCommandLists failed: " +
+                               std::to_string(result));
+    }
+  }
+
+  while (!compute_done || !copy_done) {
+    if (!compute_done &&
+        (zeEventQueryStatus(compute_event) == ZE_RESULT_SUCCESS)) {
+      compute_time = timer.stopAndTime();
+      compute_done = true;
+    }
+    if (!copy_done && (zeEventQueryStatus(copy_event) == ZE_RESULT_SUCCESS)) {
+      copy_time = timer.stopAndTime();
+      copy_done = true;
+    }
+  }
+
+  if (run_compute) {
+    result = zeCommandQueueSynchronize(context.command_queue, UINT64_MAX);
+    if (result) {
+      throw std::runtime_error("zeCommandQueueSynchronize failed: " +
+                               std::to_string(result));
+    }
+    result = zeEventHostReset(compute_event);
+    if (result) {
+      throw std::runtime_error("zeEventHostReset failed: " +
+                               std::to_string(result));
+    }
+  }
+  if (run_copy) {
+    result = zeCommandQueueSynchronize(context.copy_command_queue, UINT64_MAX);
+    if (result) {
+      throw std::runtime_error("zeCommandQueueSynchronize failed: " +
+                               std::to_string(result));
+    }
+    result = zeEventHostReset(copy_event);
+    if (result) {
+      throw std::runtime_error("zeEventHostReset failed: " +
+                               std::to_string(result));
+    }
+  }
+}
+
+//---------------------------------------------------------------------
+// Runs the float4 single precision MAD kernel on the compute queue while
+// the copy queue streams copies between pinned host memory and the
+// device. Each stream is timed alone and while overlapped with the
+// other, to report how much each slows the other down, and the overlap
+// efficiency: the share of the shorter stream hidden under the longer.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::ze_peak_overlap(L0Context &context) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+
+  std::cout << "Compute and copy overlap\n";
+  if (!context.copy_command_queue) {
+    std::cout << "No async copy engine, overlap test skipped\n";
+    print_test_complete();
+    return;
+  }
+
+  TileWorkload workload;
+  _setup_tile_sp_compute(context, workload);
+
+  size_t buffer_size = static_cast<size_t>(
+      std::min(context.device_property.maxMemAllocSize / 2,
+               uint64_t(transfer_bw_max_size)));
+
+  void *host_buffer;
+  ze_host_mem_alloc_desc_t host_desc = {};
+  host_desc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+  host_desc.pNext = nullptr;
+  host_desc.flags = 0;
+  result = zeMemAllocHost(context.context, &host_desc, buffer_size, 1,
+                          &host_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocHostMem failed: " +
+                             std::to_string(result));
+  }
+  memset(host_buffer, 0, buffer_size);
+
+  void *device_buffer;
+  ze_device_mem_alloc_desc_t device_desc = {};
+  device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+  device_desc.pNext = nullptr;
+  device_desc.ordinal = 0;
+  device_desc.flags = 0;
+  result = zeMemAllocDevice(context.context, &device_desc, buffer_size, 1,
+                            context.device, &device_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Overlap buffers allocated\n";
+
+  ze_event_pool_handle_t compute_event_pool, copy_event_pool;
+  ze_event_handle_t compute_event, copy_event;
+  single_event_pool_create(context, &compute_event_pool,
+                           ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  single_event_create(compute_event_pool, &compute_event);
+  single_event_pool_create(context, &copy_event_pool,
+                           ZE_EVENT_POOL_FLAG_HOST_VISIBLE);
+  single_event_create(copy_event_pool, &copy_event);
+
+  result = zeKernelSetGroupSize(workload.kernel,
+                                workload.workgroup_info.group_size_x,
+                                workload.workgroup_info.group_size_y,
+                                workload.workgroup_info.group_size_z);
+  if (result) {
+    throw std::runtime_error("zeKernelSetGroupSize failed: " +
+                             std::to_string(result));
+  }
+
+  /* Size both streams to take about the same time */
+  long double launch_time = 0, copy_time = 0, unused = 0;
+  append_stream(context.command_list, &workload, nullptr, nullptr, 0, 1,
+                compute_event);
+  append_stream(context.copy_command_list, nullptr, host_buffer,
+                device_buffer, buffer_size, 1, copy_event);
+  for (uint32_t i = 0; i < warmup_iterations; i++) {
+    run_streams(context, true, false, compute_event, copy_event, launch_time,
+                unused);
+    run_streams(context, false, true, compute_event, copy_event, unused,
+                copy_time);
+  }
+  context.reset_commandlist(context.command_list);
+  context.reset_commandlist(context.copy_command_list);
+
+  long double stream_time = std::max(launch_time, copy_time) *
+                            overlap_stream_length;
+  uint32_t launches = static_cast<uint32_t>(
+      std::max(1.0L, stream_time / std::max(launch_time, 1.0L)));
+  uint32_t copies = static_cast<uint32_t>(
+      std::max(1.0L, stream_time / std::max(copy_time, 1.0L)));
+  if (verbose)
+    std::cout << launches << " launches and " << copies
+              << " copies per stream\n";
+
+  append_stream(context.command_list, &workload, nullptr, nullptr, 0,
+                launches, compute_event);
+  append_stream(context.copy_command_list, nullptr, host_buffer,
+                device_buffer, buffer_size, copies, copy_event);
+
+  SampleCollector compute_alone, copy_alone;
+  SampleCollector compute_overlapped, copy_overlapped, both;
+  long double compute_sample = 0, copy_sample = 0;
+  for (uint32_t i = 0; (i < warmup_iterations) ||
+                       !sampling_complete(compute_alone) ||
+                       !sampling_complete(copy_alone) ||
+                       !sampling_complete(both);
+       i++) {
+    run_streams(context, true, false, compute_event, copy_event,
+                compute_sample, unused);
+    if (i >= warmup_iterations)
+      compute_alone.add(compute_sample);
+
+    run_streams(context, false, true, compute_event, copy_event, unused,
+                copy_sample);
+    if (i >= warmup_iterations)
+      copy_alone.add(copy_sample);
+
+    run_streams(context, true, true, compute_event, copy_event,
+                compute_sample, copy_sample);
+    if (i >= warmup_iterations) {
+      compute_overlapped.add(compute_sample);
+      copy_overlapped.add(copy_sample);
+      both.add(std::max(compute_sample, copy_sample));
+    }
+  }
+
+  context.reset_commandlist(context.command_list);
+  context.reset_commandlist(context.copy_command_list);
+
+  SampleStatistics timed;
+  long double value;
+  long double compute_work = workload.work_per_launch * launches;
+  long double copy_bytes = static_cast<long double>(buffer_size) * copies;
+
+  std::cout << "sp_compute float4 alone : ";
+  timed = compute_alone.statistics();
+  long double compute_alone_time = timed.mean;
+  value = calculate_gbps(timed.mean, compute_work);
+  report_result(context, "overlap", "compute alone", 4, value, "GFLOPS",
+                timed);
+
+  std::cout << "sp_compute float4 overlapped : ";
+  timed = compute_overlapped.statistics();
+  value = calculate_gbps(timed.mean, compute_work);
+  report_result(context, "overlap", "compute overlapped", 4, value, "GFLOPS",
+                timed);
+  std::cout << "    compute slowdown: " << timed.mean / compute_alone_time
+            << "x\n";
+
+  std::cout << "copy alone : ";
+  timed = copy_alone.statistics();
+  long double copy_alone_time = timed.mean;
+  value = calculate_gbps(timed.mean, copy_bytes);
+  report_result(context, "overlap", "copy alone", 1, value, "GBPS", timed);
+
+  std::cout << "copy overlapped : ";
+  timed = copy_overlapped.statistics();
+  value = calculate_gbps(timed.mean, copy_bytes);
+  report_result(context, "overlap", "copy overlapped", 1, value, "GBPS",
+                timed);
+  std::cout << "    copy slowdown: " << timed.mean / copy_alone_time << "x\n";
+
+  /* 100% when the shorter stream is fully hidden under the longer one */
+  timed = both.statistics();
+  long double hidden = compute_alone_time + copy_alone_time - timed.mean;
+  long double efficiency =
+      std::max(0.0L, hidden / std::min(compute_alone_time, copy_alone_time));
+  std::cout << "overlap efficiency : ";
+  report_result(context, "overlap", "efficiency", 1, efficiency * 100, "%",
+                timed);
+
+  zeEventDestroy(compute_event);
+  zeEventPoolDestroy(compute_event_pool);
+  zeEventDestroy(copy_event);
+  zeEventPoolDestroy(copy_event_pool);
+
+  result = zeMemFree(context.context, host_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+  result = zeMemFree(context.context, device_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Overlap buffers freed\n";
+
+  _release_tile_workload(context, workload);
+
+  print_test_complete();
+}
@@ -0,0 +1,191 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "../include/results.h"
+
+#include <algorithm>
+#include <boost/property_tree/json_parser.hpp>
+#include <fstream>
+
+namespace pt = boost::property_tree;
+
+bool ResultsSink::is_enabled() const {
+  return (json_file_name.size() != 0) || (csv_file_name.size() != 0);
+}
+
+//---------------------------------------------------------------------
+// Utility function to record the properties of a device that results
+// will be reported for. A device is only recorded once.
+//---------------------------------------------------------------------
+void ResultsSink::add_device(const ze_device_properties_t &props) {
+  std::string uuid = device_uuid_to_string(props.uuid);
+  if (std::find(device_uuids.begin(), device_uuids.end(), uuid) !=
+      device_uuids.end())
+    return;
+  device_uuids.push_back(uuid);
+
+  pt::ptree device;
+  device.put("uuid", uuid);
+  device.put("name", props.name);
+  device.put("vendorId", props.vendorId);
+  device.put("deviceId", props.deviceId);
+  device.put("subdeviceId", props.subdeviceId);
+  device.put("isSubdevice",
+             (props.flags & ZE_DEVICE_PROPERTY_FLAG_SUBDEVICE) != 0);
+  device.put("coreClockRate", props.coreClockRate);
+  device.put("maxMemAllocSize", props.maxMemAllocSize);
+  device.put("numSlices", props.numSlices);
+  device.put("numSubslicesPerSlice", props.numSubslicesPerSlice);
+  device.put("numEUsPerSubslice", props.numEUsPerSubslice);
+  device.put("numThreadsPerEU", props.numThreadsPerEU);
+  device.put("physicalEUSimdWidth", props.physicalEUSimdWidth);
+  device.put("timerResolution", props.timerResolution);
+  devices.push_back(std::make_pair("", device));
+}
+
+void ResultsSink::add(const ZePeakResult &result) {
+  if (is_enabled())
+    results.push_back(result);
+}
+
+void ResultsSink::write() const {
+  if (json_file_name.size() != 0)
+    write_json();
+  if (csv_file_name.size() != 0)
+    write_csv();
+}
+
+void ResultsSink::write_json() const {
+  pt::ptree results_array;
+  for (auto &result : results) {
+    pt::ptree entry;
+    entry.put("test", result.test);
+    entry.put("variant", result.variant);
+    entry.put("vectorWidth", result.vector_width);
+    entry.put("units", result.units);
+    entry.put("value", result.value);
+    entry.put("device", result.device_uuid);
+    entry.put("deviceName", result.device_name);
+    entry.put("samples.count", result.stats.count);
+    entry.put("samples.meanUs", result.stats.mean);
+    entry.put("samples.minUs", result.stats.min);
+    entry.put("samples.maxUs", result.stats.max);
+    entry.put("samples.medianUs", result.stats.median);
+    entry.put("samples.p90Us", result.stats.p90);
+    entry.put("samples.p99Us", result.stats.p99);
+    entry.put("samples.p999Us", result.stats.p999);
+    entry.put("samples.stddevUs", result.stats.stddev);
+    entry.put("samples.cv", result.stats.cv);
+    entry.put("samples.ci95Us", result.stats.ci95);
+    const TimestampBreakdown &timestamps = result.stats.timestamps;
+    if (timestamps.valid) {
+      entry.put("timestamps.hostUs", timestamps.host);
+      entry.put("timestamps.deviceUs", timestamps.device);
+      entry.put("timestamps.gapUs", timestamps.host - timestamps.device);
+      if (timestamps.correlated) {
+        entry.put("timestamps.launchUs", timestamps.launch);
+        entry.put("timestamps.completionUs", timestamps.completion);
+      }
+    }
+    const SysmanReading &sysman = result.stats.sysman;
+    if (sysman.valid) {
+      if (sysman.has_power) {
+        entry.put("sysman.powerW", sysman.power);
+        if (sysman.power > 0)
+          entry.put("sysman.valuePerWatt", result.value / sysman.power);
+      }
+      if (sysman.has_frequency) {
+        entry.put("sysman.frequencyMHz", sysman.frequency);
+        entry.put("sysman.minFrequencyMHz", sysman.min_frequency);
+        if (sysman.frequency > 0)
+          entry.put("sysman.valuePerMHz", result.value / sysman.frequency);
+      }
+      if (sysman.has_temperature)
+        entry.put("sysman.temperatureC", sysman.temperature);
+      entry.put("sysman.throttled", sysman.throttled);
+      entry.put("sysman.throttleReasons", sysman.throttle_reasons);
+    }
+    results_array.push_back(std::make_pair("", entry));
+  }
+
+  pt::ptree main;
+  main.put_child("devices", devices);
+  main.put_child("results", results_array);
+  pt::write_json(json_file_name, main);
+}
+
+//---------------------------------------------------------------------
+// Utility function to quote a CSV field, doubling the quotes it holds.
+//---------------------------------------------------------------------
+static std::string csv_quote(const std::string &field) {
+  std::string quoted = "\"";
+  for (char c : field) {
+    if (c == '"')
+      quoted += '"';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void ResultsSink::write_csv() const {
+  std::ofstream stream(csv_file_name, std::ios::out | std::ios::trunc);
+  if (!stream.good()) {
+    throw std::runtime_error("Failed to open results file: " + csv_file_name);
+  }
+
+  stream << "test,variant,vector_width,units,value,samples,mean_us,min_us,"
+            "median_us,p90_us,p99_us,p999_us,max_us,stddev_us,cv,ci95_us,"
+            "host_us,device_us,gap_us,launch_us,completion_us,"
+            "power_w,frequency_mhz,temperature_c,value_per_w,"
+            "value_per_mhz,throttled,"
+            "device_name,device_uuid\n";
+  for (auto &result : results) {
+    const TimestampBreakdown &timestamps = result.stats.timestamps;
+    stream << csv_quote(result.test) << "," << csv_quote(result.variant) << ","
+           << result.vector_width << "," << csv_quote(result.units) << ","
+           << result.value << "," << result.stats.count << ","
+           << result.stats.mean << "," << result.stats.min << ","
+           << result.stats.median << "," << result.stats.p90 << ","
+           << result.stats.p99 << "," << result.stats.p999 << ","
+           << result.stats.max << "," << result.stats.stddev << ","
+           << result.stats.cv << "," << result.stats.ci95 << ",";
+    /* Timestamp columns are left empty when they were not measured */
+    if (timestamps.valid) {
+      stream << timestamps.host << "," << timestamps.device << ","
+             << timestamps.host - timestamps.device << ",";
+    } else {
+      stream << ",,,";
+    }
+    if (timestamps.correlated) {
+      stream << timestamps.launch << "," << timestamps.completion << ",";
+    } else {
+      stream << ",,";
+    }
+    const SysmanReading &sysman = result.stats.sysman;
+    if (sysman.has_power)
+      stream << sysman.power;
+    stream << ",";
+    if (sysman.has_frequency)
+      stream << sysman.frequency;
+    stream << ",";
+    if (sysman.has_temperature)
+      stream << sysman.temperature;
+    stream << ",";
+    if (sysman.has_power && (sysman.power > 0))
+      stream << result.value / sysman.power;
+    stream << ",";
+    if (sysman.has_frequency && (sysman.frequency > 0))
+      stream << result.value / sysman.frequency;
+    stream << ",";
+    if (sysman.valid)
+      stream << (sysman.throttled ? 1 : 0);
+    stream << ",";
+    stream << csv_quote(result.device_name) << "," << result.device_uuid
+           << "\n";
+  }
+}
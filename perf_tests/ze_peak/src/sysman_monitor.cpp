@@ -0,0 +1,207 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "../include/sysman_monitor.h"
+
+#include <algorithm>
+#include <chrono>
+
+//---------------------------------------------------------------------
+// Sysman is only available when the driver is initialized with
+// ZES_ENABLE_SYSMAN set, so this has to be called before zeInit.
+//---------------------------------------------------------------------
+void enable_sysman() {
+  static char sys_env[] = "ZES_ENABLE_SYSMAN=1";
+  putenv(sys_env);
+}
+
+SysmanMonitor::~SysmanMonitor() {
+  if (sampling) {
+    sampling = false;
+    sampler.join();
+  }
+}
+
+//---------------------------------------------------------------------
+// Looks up the GPU frequency domains, the GPU temperature sensors (or
+// the global ones when there is none) and the power domain of
+// root_device. The power domain of a root device is the card level one.
+// With on_subdevice set, only the domains of sub-device subdevice_id are
+// kept, so that a tile never reports the power of the whole card.
+// Failing to query Sysman is not an error: the monitor is then simply
+// not available.
+//---------------------------------------------------------------------
+void SysmanMonitor::init(ze_device_handle_t root_device, bool on_subdevice,
+                         uint32_t subdevice_id) {
+  zes_device_handle_t sysman_device =
+      static_cast<zes_device_handle_t>(root_device);
+  uint32_t count = 0;
+
+  auto selected = [on_subdevice, subdevice_id](ze_bool_t domain_on_subdevice,
+                                               uint32_t domain_subdevice_id) {
+    return !on_subdevice ||
+           (domain_on_subdevice && (domain_subdevice_id == subdevice_id));
+  };
+
+  if ((zesDeviceEnumFrequencyDomains(sysman_device, &count, nullptr) ==
+       ZE_RESULT_SUCCESS) &&
+      count) {
+    std::vector<zes_freq_handle_t> handles(count);
+    zesDeviceEnumFrequencyDomains(sysman_device, &count, handles.data());
+    for (auto handle : handles) {
+      zes_freq_properties_t properties = {};
+      properties.stype = ZES_STRUCTURE_TYPE_FREQ_PROPERTIES;
+      if ((zesFrequencyGetProperties(handle, &properties) ==
+           ZE_RESULT_SUCCESS) &&
+          (properties.type == ZES_FREQ_DOMAIN_GPU) &&
+          selected(properties.onSubdevice, properties.subdeviceId))
+        frequency_domains.push_back(handle);
+    }
+  }
+
+  count = 0;
+  if ((zesDeviceEnumTemperatureSensors(sysman_device, &count, nullptr) ==
+       ZE_RESULT_SUCCESS) &&
+      count) {
+    std::vector<zes_temp_handle_t> handles(count);
+    std::vector<zes_temp_handle_t> global_sensors;
+    zesDeviceEnumTemperatureSensors(sysman_device, &count, handles.data());
+    for (auto handle : handles) {
+      zes_temp_properties_t properties = {};
+      properties.stype = ZES_STRUCTURE_TYPE_TEMP_PROPERTIES;
+      if ((zesTemperatureGetProperties(handle, &properties) !=
+           ZE_RESULT_SUCCESS) ||
+          !selected(properties.onSubdevice, properties.subdeviceId))
+        continue;
+      if (properties.type == ZES_TEMP_SENSORS_GPU)
+        temperature_sensors.push_back(handle);
+      else if (properties.type == ZES_TEMP_SENSORS_GLOBAL)
+        global_sensors.push_back(handle);
+    }
+    if (temperature_sensors.empty())
+      temperature_sensors = global_sensors;
+  }
+
+  count = 0;
+  if ((zesDeviceEnumPowerDomains(sysman_device, &count, nullptr) ==
+       ZE_RESULT_SUCCESS) &&
+      count) {
+    std::vector<zes_pwr_handle_t> handles(count);
+    zesDeviceEnumPowerDomains(sysman_device, &count, handles.data());
+    for (auto handle : handles) {
+      zes_power_properties_t properties = {};
+      properties.stype = ZES_STRUCTURE_TYPE_POWER_PROPERTIES;
+      if (zesPowerGetProperties(handle, &properties) != ZE_RESULT_SUCCESS)
+        continue;
+      if (on_subdevice ? selected(properties.onSubdevice,
+                                  properties.subdeviceId)
+                       : !properties.onSubdevice) {
+        power_domain = handle;
+        break;
+      }
+    }
+  }
+}
+
+bool SysmanMonitor::available() const {
+  return !frequency_domains.empty() || !temperature_sensors.empty() ||
+         power_domain;
+}
+
+//---------------------------------------------------------------------
+// Takes one frequency and temperature sample.
+//---------------------------------------------------------------------
+void SysmanMonitor::sample() {
+  std::lock_guard<std::mutex> lock(reading_mutex);
+
+  for (auto handle : frequency_domains) {
+    zes_freq_state_t state = {};
+    state.stype = ZES_STRUCTURE_TYPE_FREQ_STATE;
+    if (zesFrequencyGetState(handle, &state) != ZE_RESULT_SUCCESS)
+      continue;
+    if (state.actual > 0) {
+      reading.min_frequency = reading.has_frequency
+                                  ? std::min(reading.min_frequency,
+                                             (long double)state.actual)
+                                  : state.actual;
+      reading.has_frequency = true;
+      frequency_sum += state.actual;
+      frequency_samples++;
+    }
+    reading.throttle_reasons |= state.throttleReasons;
+  }
+
+  for (auto handle : temperature_sensors) {
+    double temperature = 0;
+    if (zesTemperatureGetState(handle, &temperature) != ZE_RESULT_SUCCESS)
+      continue;
+    reading.temperature =
+        reading.has_temperature
+            ? std::max(reading.temperature, (long double)temperature)
+            : temperature;
+    reading.has_temperature = true;
+  }
+}
+
+//---------------------------------------------------------------------
+// Starts sampling every period_ms on a background thread. The energy
+// counter is read now and at stop(), to get the average power.
+//---------------------------------------------------------------------
+void SysmanMonitor::start() {
+  if (sampling)
+    stop();
+
+  reading = SysmanReading();
+  frequency_sum = 0;
+  frequency_samples = 0;
+  if (power_domain)
+    reading.has_power = zesPowerGetEnergyCounter(power_domain,
+                                                 &start_energy) ==
+                        ZE_RESULT_SUCCESS;
+
+  sample();
+  sampling = true;
+  sampler = std::thread([this]() {
+    while (sampling) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(period_ms));
+      sample();
+    }
+  });
+}
+
+//---------------------------------------------------------------------
+// Stops sampling and returns what was seen since start().
+//---------------------------------------------------------------------
+SysmanReading SysmanMonitor::stop() {
+  if (!sampling)
+    return SysmanReading();
+
+  sampling = false;
+  sampler.join();
+  sample();
+
+  if (reading.has_power) {
+    zes_power_energy_counter_t end_energy = {};
+    reading.has_power =
+        (zesPowerGetEnergyCounter(power_domain, &end_energy) ==
+         ZE_RESULT_SUCCESS) &&
+        (end_energy.timestamp > start_energy.timestamp);
+    /* microjoules over microseconds */
+    if (reading.has_power)
+      reading.power =
+          (long double)(end_energy.energy - start_energy.energy) /
+          (end_energy.timestamp - start_energy.timestamp);
+  }
+
+  if (frequency_samples)
+    reading.frequency = frequency_sum / frequency_samples;
+  reading.throttled = reading.throttle_reasons != 0;
+  reading.valid =
+      reading.has_power || reading.has_frequency || reading.has_temperature;
+  return reading;
+}
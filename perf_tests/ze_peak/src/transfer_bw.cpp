@@ -8,7 +8,9 @@
 
 #include "../include/ze_peak.h"
 
-void ZePeak::_transfer_bw_gpu_copy(L0Context &context, void *destination_buffer,
+void ZePeak::_transfer_bw_gpu_copy(L0Context &context,
+                                   const std::string &variant,
+                                   void *destination_buffer,
                                    void *source_buffer, size_t buffer_size) {
   Timer timer;
   long double gbps = 0, timed = 0;
@@ -52,7 +54,13 @@ void ZePeak::_transfer_bw_gpu_copy(L0Context &context, void *destination_buffer,
 
   gbps = calculate_gbps(timed, static_cast<long double>(buffer_size));
 
-  std::cout << gbps << " GBPS\n";
+  SampleStatistics stats;
+  if (use_event_timer)
+    stats.timestamps = _transfer_bw_event_copy(
+        context, false, destination_buffer, source_buffer, buffer_size);
+
+  std::cout << variant << " : ";
+  report_result(context, "transfer_bw", variant, 1, gbps, "GBPS", stats);
 
   if (context.copy_command_queue) {
     timer.start();
@@ -72,16 +80,112 @@ void ZePeak::_transfer_bw_gpu_copy(L0Context &context, void *destination_buffer,
 
     gbps = calculate_gbps(timed, static_cast<long double>(buffer_size));
 
-    std::cout << "\t With Blitter Engine: " << gbps << " GBPS\n";
+    if (use_event_timer)
+      stats.timestamps = _transfer_bw_event_copy(
+          context, true, destination_buffer, source_buffer, buffer_size);
+
+    std::cout << "\t With Blitter Engine: ";
+    report_result(context, "transfer_bw", variant + " (blitter)", 1, gbps,
+                  "GBPS", stats);
+  }
+}
+
+//---------------------------------------------------------------------
+// Utility function to time one submission of iters copies with kernel
+// timestamps on the first and the last copy, on the compute queue or on
+// the copy queue. The host time runs from the submission to the end of
+// the queue synchronization.
+// On success, the time per copy is returned.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+TimestampBreakdown ZePeak::_transfer_bw_event_copy(L0Context &context,
+                                                   bool use_copy_queue,
+                                                   void *destination_buffer,
+                                                   void *source_buffer,
+                                                   size_t buffer_size) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  ze_command_list_handle_t command_list =
+      use_copy_queue ? context.copy_command_list : context.command_list;
+  TimestampSamples samples;
+  Timer timer;
+
+  ze_event_pool_handle_t event_pool;
+  ze_event_pool_desc_t event_pool_desc = {};
+  event_pool_desc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+  event_pool_desc.pNext = nullptr;
+  event_pool_desc.flags =
+      ZE_EVENT_POOL_FLAG_HOST_VISIBLE | ZE_EVENT_POOL_FLAG_KERNEL_TIMESTAMP;
+  event_pool_desc.count = 2;
+  result = zeEventPoolCreate(context.context, &event_pool_desc, 1,
+                             &context.device, &event_pool);
+  if (result) {
+    throw std::runtime_error("zeEventPoolCreate failed: " +
+                             std::to_string(result));
+  }
+
+  ze_event_handle_t events[2];
+  for (uint32_t i = 0; i < 2; i++) {
+    ze_event_desc_t event_desc = {};
+    event_desc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+    event_desc.pNext = nullptr;
+    event_desc.index = i;
+    event_desc.signal = 0;
+    event_desc.wait = 0;
+    result = zeEventCreate(event_pool, &event_desc, &events[i]);
+    if (result) {
+      throw std::runtime_error("zeEventCreate failed: " +
+                               std::to_string(result));
+    }
+  }
+  /* A single copy signals the first event only */
+  ze_event_handle_t last_event = (iters > 1) ? events[1] : events[0];
+
+  for (uint32_t i = 0; i < iters; i++) {
+    ze_event_handle_t event = nullptr;
+    if (i == 0)
+      event = events[0];
+    else if (i == iters - 1)
+      event = last_event;
+
+    result = zeCommandListAppendMemoryCopy(command_list, destination_buffer,
+                                           source_buffer, buffer_size, event,
+                                           0, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandListAppendMemoryCopy failed: " +
+                               std::to_string(result));
+    }
   }
+
+  uint64_t submit_timestamp = 0;
+  bool correlated = read_device_timestamp(context, submit_timestamp);
+  timer.start();
+  context.execute_commandlist_and_sync(use_copy_queue);
+  long double host_time = timer.stopAndTime();
+
+  add_timestamp_sample(context, samples, events[0], last_event,
+                       submit_timestamp, correlated, host_time);
+
+  zeEventDestroy(events[0]);
+  zeEventDestroy(events[1]);
+  zeEventPoolDestroy(event_pool);
+
+  TimestampBreakdown breakdown = samples.breakdown();
+  breakdown.host /= iters;
+  breakdown.device /= iters;
+  breakdown.launch /= iters;
+  breakdown.completion /= iters;
+  return breakdown;
 }
 
 void ZePeak::_transfer_bw_host_copy(L0Context &context,
+                                    const std::string &variant,
                                     void *destination_buffer,
                                     void *source_buffer, size_t buffer_size,
                                     bool shared_is_dest) {
   Timer timer;
-  long double gbps = 0, timed = 0;
+  long double gbps = 0;
+  SampleCollector samples;
+  samples.reserve(iters);
 
   ze_command_list_handle_t temp_cmd_list = nullptr;
   ze_command_queue_desc_t cmd_q_desc = {};
@@ -108,7 +212,7 @@ void ZePeak::_transfer_bw_host_copy(L0Context &context,
     memcpy(destination_buffer, source_buffer, buffer_size);
   }
 
-  for (uint32_t i = 0; i < iters; i++) {
+  while (!sampling_complete(samples)) {
     uint8_t pattern = 0x0;
     size_t pattern_size = 1;
     zeCommandListAppendMemoryFill(
@@ -117,13 +221,14 @@ void ZePeak::_transfer_bw_host_copy(L0Context &context,
 
     timer.start();
     memcpy(destination_buffer, source_buffer, buffer_size);
-    timed += timer.stopAndTime();
+    samples.add(timer.stopAndTime());
   }
 
-  timed /= static_cast<long double>(iters);
-  gbps = calculate_gbps(timed, static_cast<long double>(buffer_size));
+  SampleStatistics timed = samples.statistics();
+  gbps = calculate_gbps(timed.mean, static_cast<long double>(buffer_size));
 
-  std::cout << gbps << " GBPS\n";
+  std::cout << variant << " : ";
+  report_result(context, "transfer_bw", variant, 1, gbps, "GBPS", timed);
 
   zeCommandListDestroy(temp_cmd_list);
 }
@@ -155,18 +260,17 @@ void ZePeak::_transfer_bw_shared_memory(L0Context &context,
                              std::to_string(result));
   }
 
-  std::cout << "GPU Copy Host to Shared Memory : ";
-  _transfer_bw_gpu_copy(context, shared_memory_buffer, local_memory.data(),
+  _transfer_bw_gpu_copy(context, "GPU Copy Host to Shared Memory",
+                        shared_memory_buffer, local_memory.data(),
                         local_memory_size);
-
-  std::cout << "GPU Copy Shared Memory to Host : ";
-  _transfer_bw_gpu_copy(context, local_memory.data(), shared_memory_buffer,
+  _transfer_bw_gpu_copy(context, "GPU Copy Shared Memory to Host",
+                        local_memory.data(), shared_memory_buffer,
                         local_memory_size);
-  std::cout << "System Memory Copy to Shared Memory : ";
-  _transfer_bw_host_copy(context, shared_memory_buffer, local_memory.data(),
+  _transfer_bw_host_copy(context, "System Memory Copy to Shared Memory",
+                         shared_memory_buffer, local_memory.data(),
                          local_memory_size, true);
-  std::cout << "System Memory Copy from Shared Memory : ";
-  _transfer_bw_host_copy(context, local_memory.data(), shared_memory_buffer,
+  _transfer_bw_host_copy(context, "System Memory Copy from Shared Memory",
+                         local_memory.data(), shared_memory_buffer,
                          local_memory_size, false);
 
   result = zeMemFree(context.context, shared_memory_buffer);
@@ -176,6 +280,210 @@ void ZePeak::_transfer_bw_shared_memory(L0Context &context,
   }
 }
 
+//---------------------------------------------------------------------
+// Measures transfers between the device and pinned host memory
+// allocated with zeMemAllocHost, to compare with the pageable memory
+// used by enqueueWriteBuffer and enqueueReadBuffer.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::_transfer_bw_pinned_memory(L0Context &context,
+                                        void *device_buffer,
+                                        size_t buffer_size) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  void *host_buffer = nullptr;
+
+  ze_host_mem_alloc_desc_t host_desc = {};
+  host_desc.stype = ZE_STRUCTURE_TYPE_HOST_MEM_ALLOC_DESC;
+
+  host_desc.pNext = nullptr;
+  host_desc.flags = 0;
+  result = zeMemAllocHost(context.context, &host_desc, buffer_size, 1,
+                          &host_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocHostMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "pinned host buffer allocated\n";
+
+  memset(host_buffer, 0, buffer_size);
+
+  _transfer_bw_gpu_copy(context, "enqueueWriteBuffer from Pinned Memory",
+                        device_buffer, host_buffer, buffer_size);
+  _transfer_bw_gpu_copy(context, "enqueueReadBuffer to Pinned Memory",
+                        host_buffer, device_buffer, buffer_size);
+
+  if (run_pipelined_transfer) {
+    _transfer_bw_pipelined(context, "Pipelined Write from Pinned Memory",
+                           device_buffer, host_buffer, buffer_size);
+    _transfer_bw_pipelined(context, "Pipelined Read to Pinned Memory",
+                           host_buffer, device_buffer, buffer_size);
+  }
+
+  result = zeMemFree(context.context, host_buffer);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "pinned host buffer freed\n";
+}
+
+//---------------------------------------------------------------------
+// Measures a transfer split into chunks for a range of chunk counts.
+// The chunks are appended round-robin to the compute and the copy
+// command lists, both queues are submitted together, and the transfer
+// is complete once the events signaled by every chunk are.
+// Without a copy engine all the chunks go to the compute command list.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::_transfer_bw_pipelined(L0Context &context,
+                                    const std::string &variant,
+                                    void *destination_buffer,
+                                    void *source_buffer, size_t buffer_size) {
+  static const uint32_t max_chunks = 64;
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  bool use_copy_engine = context.copy_command_queue != nullptr;
+  Timer timer;
+
+  ze_event_pool_handle_t event_pool;
+  ze_event_pool_desc_t event_pool_desc = {};
+  event_pool_desc.stype = ZE_STRUCTURE_TYPE_EVENT_POOL_DESC;
+  event_pool_desc.pNext = nullptr;
+  event_pool_desc.flags = ZE_EVENT_POOL_FLAG_HOST_VISIBLE;
+  event_pool_desc.count = max_chunks;
+  result = zeEventPoolCreate(context.context, &event_pool_desc, 1,
+                             &context.device, &event_pool);
+  if (result) {
+    throw std::runtime_error("zeEventPoolCreate failed: " +
+                             std::to_string(result));
+  }
+
+  std::vector<ze_event_handle_t> events(max_chunks);
+  for (uint32_t i = 0; i < max_chunks; i++) {
+    ze_event_desc_t event_desc = {};
+    event_desc.stype = ZE_STRUCTURE_TYPE_EVENT_DESC;
+    event_desc.pNext = nullptr;
+    event_desc.index = i;
+    event_desc.signal = ZE_EVENT_SCOPE_FLAG_HOST;
+    event_desc.wait = ZE_EVENT_SCOPE_FLAG_HOST;
+    result = zeEventCreate(event_pool, &event_desc, &events[i]);
+    if (result) {
+      throw std::runtime_error("zeEventCreate failed: " +
+                               std::to_string(result));
+    }
+  }
+
+  std::cout << variant << (use_copy_engine ? " (compute + copy engines)" : "")
+            << "\n";
+
+  for (uint32_t chunks = 1; chunks <= max_chunks; chunks *= 2) {
+    size_t chunk_size = buffer_size / chunks;
+    SampleCollector samples;
+    samples.reserve(iters);
+
+    for (uint32_t i = 0; i < chunks; i++) {
+      ze_command_list_handle_t command_list =
+          (use_copy_engine && (i % 2)) ? context.copy_command_list
+                                       : context.command_list;
+      size_t offset = i * chunk_size;
+      size_t size = (i == chunks - 1) ? buffer_size - offset : chunk_size;
+
+      result = zeCommandListAppendMemoryCopy(
+          command_list, static_cast<uint8_t *>(destination_buffer) + offset,
+          static_cast<uint8_t *>(source_buffer) + offset, size, events[i], 0,
+          nullptr);
+      if (result) {
+        throw std::runtime_error("zeCommandListAppendMemoryCopy failed: " +
+                                 std::to_string(result));
+      }
+    }
+
+    result = zeCommandListClose(context.command_list);
+    if (result) {
+      throw std::runtime_error("zeCommandListClose failed: " +
+                               std::to_string(result));
+    }
+    if (use_copy_engine) {
+      result = zeCommandListClose(context.copy_command_list);
+      if (result) {
+        throw std::runtime_error("zeCommandListClose failed: " +
+                                 std::to_string(result));
+      }
+    }
+
+    for (uint32_t i = 0;
+         (i < warmup_iterations) || !sampling_complete(samples); i++) {
+      timer.start();
+      result = zeCommandQueueExecuteCommandLists(
+          context.command_queue, 1, &context.command_list, nullptr);
+      if (result) {
+        throw std::runtime_error("zeCommandQueueExecuteCommandLists failed: " +
+                                 std::to_string(result));
+      }
+      if (use_copy_engine) {
+        result = zeCommandQueueExecuteCommandLists(
+            context.copy_command_queue, 1, &context.copy_command_list,
+            nullptr);
+        if (result) {
+          throw std::runtime_error(
+              "zeCommandQueueExecuteCommandLists failed: " +
+              std::to_string(result));
+        }
+      }
+
+      for (uint32_t j = 0; j < chunks; j++) {
+        result = zeEventHostSynchronize(events[j], UINT64_MAX);
+        if (result) {
+          throw std::runtime_error("zeEventHostSynchronize failed: " +
+                                   std::to_string(result));
+        }
+      }
+      long double elapsed = timer.stopAndTime();
+      if (i >= warmup_iterations)
+        samples.add(elapsed);
+
+      synchronize_command_queue(context);
+      if (use_copy_engine) {
+        result =
+            zeCommandQueueSynchronize(context.copy_command_queue, UINT64_MAX);
+        if (result) {
+          throw std::runtime_error("zeCommandQueueSynchronize failed: " +
+                                   std::to_string(result));
+        }
+      }
+
+      for (uint32_t j = 0; j < chunks; j++) {
+        result = zeEventHostReset(events[j]);
+        if (result) {
+          throw std::runtime_error("zeEventHostReset failed: " +
+                                   std::to_string(result));
+        }
+      }
+    }
+
+    context.reset_commandlist(context.command_list);
+    if (use_copy_engine)
+      context.reset_commandlist(context.copy_command_list);
+
+    SampleStatistics timed = samples.statistics();
+    long double gbps =
+        calculate_gbps(timed.mean, static_cast<long double>(buffer_size));
+
+    std::string chunk_variant = variant + ", " + std::to_string(chunks) +
+                                " chunks of " +
+                                std::to_string(chunk_size >> 10) + " KB";
+    std::cout << "\t" << chunks << " chunks of " << (chunk_size >> 10)
+              << " KB : ";
+    report_result(context, "transfer_bw", chunk_variant, 1, gbps, "GBPS",
+                  timed);
+  }
+
+  for (auto event : events)
+    zeEventDestroy(event);
+  zeEventPoolDestroy(event_pool);
+}
+
 void ZePeak::ze_peak_transfer_bw(L0Context &context) {
   ze_result_t result = ZE_RESULT_SUCCESS;
   uint64_t max_number_of_allocated_items =
@@ -211,13 +519,12 @@ void ZePeak::ze_peak_transfer_bw(L0Context &context) {
 
   std::cout << "Transfer Bandwidth (GBPS)\n";
 
-  std::cout << "enqueueWriteBuffer : ";
-  _transfer_bw_gpu_copy(context, device_buffer, local_memory.data(),
-                        local_memory_size);
+  _transfer_bw_gpu_copy(context, "enqueueWriteBuffer", device_buffer,
+                        local_memory.data(), local_memory_size);
+  _transfer_bw_gpu_copy(context, "enqueueReadBuffer", local_memory.data(),
+                        device_buffer, local_memory_size);
 
-  std::cout << "enqueueReadBuffer : ";
-  _transfer_bw_gpu_copy(context, local_memory.data(), device_buffer,
-                        local_memory_size);
+  _transfer_bw_pinned_memory(context, device_buffer, local_memory_size);
 
   _transfer_bw_shared_memory(context, local_memory);
 
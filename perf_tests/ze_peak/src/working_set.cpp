@@ -0,0 +1,205 @@
+/*
+ *
+ * Copyright (C) 2020 Intel Corporation
+ *
+ * SPDX-License-Identifier: MIT
+ *
+ */
+
+#include "../include/ze_peak.h"
+
+#include <algorithm>
+
+/* Smallest working set measured, in bytes */
+static const uint64_t min_working_set = 4 * 1024;
+/* Bytes read by one launch; small working sets are read several times */
+static const uint64_t bytes_per_launch = 256 * 1024 * 1024;
+/* A drop below this fraction of the current plateau is reported as a knee */
+static const long double knee_ratio = 0.75;
+
+static std::string format_size(uint64_t bytes) {
+  if (bytes >= (1 << 30))
+    return std::to_string(bytes >> 30) + " GB";
+  if (bytes >= (1 << 20))
+    return std::to_string(bytes >> 20) + " MB";
+  return std::to_string(bytes >> 10) + " KB";
+}
+
+//---------------------------------------------------------------------
+// Measures the global memory bandwidth of working sets of doubling size,
+// from a few KB up to maxMemAllocSize, to expose the bandwidth of each
+// level of the cache hierarchy. The curve is followed by the knee
+// points where the bandwidth falls off.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::ze_peak_working_set(L0Context &context) {
+  long double gbps;
+  SampleStatistics timed;
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  struct ZeWorkGroups workgroup_info;
+  TimingMeasurement type = is_bandwidth_with_event_timer();
+  uint32_t offset_mask = 0;
+  const uint64_t element_size = 4 * sizeof(float);
+
+  std::vector<uint8_t> binary_file =
+      context.load_binary_file("ze_working_set.spv");
+  if (binary_file.empty()) {
+    std::cout << "Working set bandwidth : skipped, build ze_working_set.spv "
+                 "from kernels/ze_working_set.cl to run it\n";
+    return;
+  }
+
+  context.create_module(binary_file);
+
+  std::vector<std::string> available = context.get_kernel_names();
+  if (std::find(available.begin(), available.end(),
+                "global_bandwidth_v4_passes") == available.end()) {
+    std::cout << "Working set bandwidth : skipped, global_bandwidth_v4_passes "
+                 "not found in ze_working_set.spv\n";
+    result = zeModuleDestroy(context.module);
+    if (result) {
+      throw std::runtime_error("zeModuleDestroy failed: " +
+                               std::to_string(result));
+    }
+    if (verbose)
+      std::cout << "Module destroyed\n";
+    return;
+  }
+
+  uint64_t max_working_set = context.device_property.maxMemAllocSize;
+  uint64_t max_work_items = max_working_set / element_size / FETCH_PER_WI;
+
+  void *inputBuf;
+  ze_device_mem_alloc_desc_t in_device_desc = {};
+  in_device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+  in_device_desc.pNext = nullptr;
+  in_device_desc.ordinal = 0;
+  in_device_desc.flags = 0;
+  result = zeMemAllocDevice(context.context, &in_device_desc,
+                            static_cast<size_t>(max_working_set), 1,
+                            context.device, &inputBuf);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "inputBuf device buffer allocated\n";
+
+  void *outputBuf;
+  ze_device_mem_alloc_desc_t out_device_desc = {};
+  out_device_desc.stype = ZE_STRUCTURE_TYPE_DEVICE_MEM_ALLOC_DESC;
+
+  out_device_desc.pNext = nullptr;
+  out_device_desc.ordinal = 0;
+  out_device_desc.flags = 0;
+  result = zeMemAllocDevice(context.context, &out_device_desc,
+                            static_cast<size_t>(max_work_items * sizeof(float)),
+                            1, context.device, &outputBuf);
+  if (result) {
+    throw std::runtime_error("zeDriverAllocDeviceMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "outputBuf device buffer allocated\n";
+
+  result = zeCommandListAppendMemoryFill(context.command_list, inputBuf,
+                                         &offset_mask, sizeof(offset_mask),
+                                         max_working_set, nullptr, 0, nullptr);
+  if (result) {
+    throw std::runtime_error("zeCommandListAppendMemoryFill failed: " +
+                             std::to_string(result));
+  }
+  context.execute_commandlist_and_sync();
+
+  ze_kernel_handle_t passes_v4;
+  setup_function(context, passes_v4, "global_bandwidth_v4_passes", inputBuf,
+                 outputBuf);
+
+  result = zeKernelSetArgumentValue(passes_v4, 3, sizeof(offset_mask),
+                                    &offset_mask);
+  if (result) {
+    throw std::runtime_error("zeKernelSetArgumentValue failed: " +
+                             std::to_string(result));
+  }
+
+  std::cout << "Working set bandwidth (GBPS)\n";
+
+  std::vector<uint64_t> sizes;
+  std::vector<long double> bandwidths;
+
+  for (uint64_t size = min_working_set; size <= max_working_set; size *= 2) {
+    uint64_t work_items = set_workgroups(
+        context, size / element_size / FETCH_PER_WI, &workgroup_info);
+    uint64_t bytes_per_pass = work_items * FETCH_PER_WI * element_size;
+    uint32_t passes = static_cast<uint32_t>(
+        std::max(uint64_t(1), bytes_per_launch / bytes_per_pass));
+
+    result = zeKernelSetArgumentValue(passes_v4, 2, sizeof(passes), &passes);
+    if (result) {
+      throw std::runtime_error("zeKernelSetArgumentValue failed: " +
+                               std::to_string(result));
+    }
+
+    std::cout << format_size(size) << " : ";
+    timed = run_kernel(context, passes_v4, workgroup_info, type);
+    gbps = calculate_gbps(timed.mean, bytes_per_pass * passes);
+    report_result(context, "working_set", format_size(size), 4, gbps, "GBPS",
+                  timed);
+
+    sizes.push_back(size);
+    bandwidths.push_back(gbps);
+  }
+
+  /* A knee is a drop well below the best bandwidth of the current level */
+  std::cout << "Knee points\n";
+  bool knee_found = false;
+  long double plateau = bandwidths.size() ? bandwidths[0] : 0;
+  for (size_t i = 1; i < bandwidths.size(); i++) {
+    if (bandwidths[i] < plateau * knee_ratio) {
+      std::cout << "Knee between " << format_size(sizes[i - 1]) << " and "
+                << format_size(sizes[i]) << ": " << plateau << " GBPS -> "
+                << bandwidths[i] << " GBPS\n";
+      plateau = bandwidths[i];
+      knee_found = true;
+    } else {
+      plateau = std::max(plateau, bandwidths[i]);
+    }
+  }
+  if (!knee_found)
+    std::cout << "No knee found\n";
+
+  result = zeKernelDestroy(passes_v4);
+  if (result) {
+    throw std::runtime_error("zeKernelDestroy failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "passes_v4 Function Destroyed\n";
+
+  result = zeMemFree(context.context, inputBuf);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Input Buffer freed\n";
+
+  result = zeMemFree(context.context, outputBuf);
+  if (result) {
+    throw std::runtime_error("zeDriverFreeMem failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Output Buffer freed\n";
+
+  result = zeModuleDestroy(context.module);
+  if (result) {
+    throw std::runtime_error("zeModuleDestroy failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Module destroyed\n";
+
+  print_test_complete();
+}
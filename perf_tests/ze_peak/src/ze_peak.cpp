@@ -63,12 +63,30 @@ void L0Context::reset_commandlist(ze_command_list_handle_t cmd_list) {
 
 //---------------------------------------------------------------------
 // Utility function to create the L0 module from a binary file.
+// With a module cache directory set, the native binary built for this
+// device and driver is loaded from the cache instead when it is there,
+// and saved to it otherwise.
 // If successful, this function will set the context's module
 // handle to a valid value for use in future calls.
 // On error, an exception will be thrown describing the failure.
 //---------------------------------------------------------------------
 void L0Context::create_module(std::vector<uint8_t> binary_file) {
   ze_result_t result = ZE_RESULT_SUCCESS;
+  Timer timer;
+
+  timer.start();
+  module_loads.modules++;
+
+  std::string cache_path;
+  if (!module_cache_dir.empty()) {
+    cache_path = module_cache_path(binary_file);
+    if (create_module_from_cache(cache_path)) {
+      module_loads.cache_hits++;
+      module_loads.time_us += timer.stopAndTime();
+      return;
+    }
+  }
+
   ze_module_desc_t module_description = {};
   module_description.stype = ZE_STRUCTURE_TYPE_MODULE_DESC;
 
@@ -87,6 +105,34 @@ void L0Context::create_module(std::vector<uint8_t> binary_file) {
   }
   if (verbose)
     std::cout << "Module created\n";
+
+  if (!cache_path.empty())
+    save_module_to_cache(cache_path);
+  module_loads.time_us += timer.stopAndTime();
+}
+
+//---------------------------------------------------------------------
+// Utility function to list the kernels of the context's module, so that
+// tests can skip kernels missing from a SPIR-V binary older than the .cl
+// sources instead of failing.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+std::vector<std::string> L0Context::get_kernel_names() {
+  uint32_t count = 0;
+  ze_result_t result = zeModuleGetKernelNames(module, &count, nullptr);
+  if (result) {
+    throw std::runtime_error("zeModuleGetKernelNames failed: " +
+                             std::to_string(result));
+  }
+
+  std::vector<const char *> names(count);
+  result = zeModuleGetKernelNames(module, &count, names.data());
+  if (result) {
+    throw std::runtime_error("zeModuleGetKernelNames failed: " +
+                             std::to_string(result));
+  }
+
+  return std::vector<std::string>(names.begin(), names.end());
 }
 
 #define MAX_UUID_STRING_SIZE 49
@@ -106,6 +152,12 @@ static void generic_uuid_to_string(const uint8_t *id, int bytes, char *s) {
   *s = '\0';
 }
 
+std::string device_uuid_to_string(const ze_device_uuid_t &uuid) {
+  char id[MAX_UUID_STRING_SIZE];
+  generic_uuid_to_string(uuid.id, ZE_MAX_DEVICE_UUID_SIZE, id);
+  return std::string(id);
+}
+
 //---------------------------------------------------------------------
 // Utility function to print the device properties from zeDeviceGetProperties.
 //---------------------------------------------------------------------
@@ -137,8 +189,28 @@ void L0Context::print_ze_device_properties(
 //---------------------------------------------------------------------
 void L0Context::init_xe(uint32_t specified_platform,
                         uint32_t specified_device) {
-  ze_command_list_desc_t command_list_description{};
-  ze_command_queue_desc_t command_queue_description{};
+  init_driver(specified_platform);
+
+  std::vector<ze_device_handle_t> devices = get_devices(false);
+  device_count = static_cast<uint32_t>(devices.size());
+
+  ze_device_handle_t selected_device = devices[0];
+  if (specified_device >= device_count)
+    std::cout << "Specified device " << specified_device
+              << " is not valid, will default to the first device" << std::endl;
+  else
+    selected_device = devices[specified_device];
+
+  init_device(selected_device);
+}
+
+//---------------------------------------------------------------------
+// Utility function to initialize the ze driver selected by
+// specified_platform and to create the context that manages all the
+// resources of this L0Context.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void L0Context::init_driver(uint32_t specified_platform) {
   ze_result_t result = ZE_RESULT_SUCCESS;
 
   result = zeInit(0);
@@ -155,13 +227,20 @@ void L0Context::init_xe(uint32_t specified_platform,
     throw std::runtime_error("zeDriverGet failed: " + std::to_string(result));
   }
 
-  /* Retrieve only one driver */
-  driver_count = 1;
-  result = zeDriverGet(&driver_count, &driver);
+  std::vector<ze_driver_handle_t> drivers(driver_count);
+  result = zeDriverGet(&driver_count, drivers.data());
   if (result) {
     throw std::runtime_error("zeDriverGet failed: " + std::to_string(result));
   }
 
+  driver = drivers[0];
+  if (specified_platform >= driver_count)
+    std::cout << "Specified platform " << specified_platform
+              << " is not valid, will default to the first platform"
+              << std::endl;
+  else
+    driver = drivers[specified_platform];
+
   /* Create a context to manage resources */
   ze_context_desc_t context_desc = {};
   context_desc.stype = ZE_STRUCTURE_TYPE_CONTEXT_DESC;
@@ -170,29 +249,121 @@ void L0Context::init_xe(uint32_t specified_platform,
     throw std::runtime_error("zeContextCreate failed: " +
                              std::to_string(result));
   }
+  owns_context = true;
+}
 
-  device_count = 0;
-  result = zeDeviceGet(driver, &device_count, nullptr);
-  if (result || device_count == 0) {
+//---------------------------------------------------------------------
+// Utility function to retrieve the devices of the driver. When
+// include_subdevices is set, every root device is followed by its
+// sub-devices (tiles).
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+std::vector<ze_device_handle_t>
+L0Context::get_devices(bool include_subdevices) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+
+  uint32_t count = 0;
+  result = zeDeviceGet(driver, &count, nullptr);
+  if (result || count == 0) {
     throw std::runtime_error("zeDeviceGet failed: " + std::to_string(result));
   }
   if (verbose)
-    std::cout << "Device count retrieved: " << device_count << "\n";
+    std::cout << "Device count retrieved: " << count << "\n";
 
-  std::vector<ze_device_handle_t> devices(device_count);
-  result = zeDeviceGet(driver, &device_count, devices.data());
+  std::vector<ze_device_handle_t> root_devices(count);
+  result = zeDeviceGet(driver, &count, root_devices.data());
   if (result) {
     throw std::runtime_error("zeDeviceGet failed: " + std::to_string(result));
   }
   if (verbose)
     std::cout << "Device retrieved\n";
 
-  device = devices[0];
-  if (specified_device >= device_count)
-    std::cout << "Specified device " << specified_device
-              << " is not valid, will default to the first device" << std::endl;
-  else
-    device = devices[specified_device];
+  if (!include_subdevices)
+    return root_devices;
+
+  std::vector<ze_device_handle_t> devices;
+  for (auto root_device : root_devices) {
+    devices.push_back(root_device);
+    std::vector<ze_device_handle_t> sub_devices = get_sub_devices(root_device);
+    devices.insert(devices.end(), sub_devices.begin(), sub_devices.end());
+  }
+  return devices;
+}
+
+//---------------------------------------------------------------------
+// Utility function to retrieve the sub-devices of a device. A device
+// without sub-devices returns an empty list.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+std::vector<ze_device_handle_t>
+L0Context::get_sub_devices(ze_device_handle_t root_device) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+
+  uint32_t count = 0;
+  result = zeDeviceGetSubDevices(root_device, &count, nullptr);
+  if (result) {
+    throw std::runtime_error("zeDeviceGetSubDevices failed: " +
+                             std::to_string(result));
+  }
+
+  std::vector<ze_device_handle_t> sub_devices(count);
+  if (count) {
+    result = zeDeviceGetSubDevices(root_device, &count, sub_devices.data());
+    if (result) {
+      throw std::runtime_error("zeDeviceGetSubDevices failed: " +
+                               std::to_string(result));
+    }
+  }
+  if (verbose)
+    std::cout << "Sub-device count retrieved: " << count << "\n";
+
+  return sub_devices;
+}
+
+//---------------------------------------------------------------------
+// Utility function to find the root device that sub_device belongs to.
+// A device that is not a sub-device of any root device is returned
+// unchanged.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+ze_device_handle_t L0Context::get_root_device(ze_device_handle_t sub_device) {
+  for (auto root_device : get_devices(false)) {
+    std::vector<ze_device_handle_t> sub_devices = get_sub_devices(root_device);
+    if (std::find(sub_devices.begin(), sub_devices.end(), sub_device) !=
+        sub_devices.end())
+      return root_device;
+  }
+  return sub_device;
+}
+
+//---------------------------------------------------------------------
+// Utility function to initialize another L0Context on a device of the
+// same driver, sharing the driver and context of parent.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void L0Context::init_xe(const L0Context &parent,
+                        ze_device_handle_t selected_device) {
+  driver = parent.driver;
+  context = parent.context;
+  device_count = parent.device_count;
+  owns_context = false;
+  module_cache_dir = parent.module_cache_dir;
+  use_sysman = parent.use_sysman;
+
+  init_device(selected_device);
+}
+
+//---------------------------------------------------------------------
+// Utility function to retrieve the device properties and to create the
+// command lists and command queues used on selected_device.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void L0Context::init_device(ze_device_handle_t selected_device) {
+  ze_command_list_desc_t command_list_description{};
+  ze_command_queue_desc_t command_queue_description{};
+  ze_result_t result = ZE_RESULT_SUCCESS;
+
+  device = selected_device;
 
   device_property.stype = ZE_STRUCTURE_TYPE_DEVICE_PROPERTIES;
   device_property.pNext = nullptr;
@@ -292,6 +463,22 @@ void L0Context::init_xe(uint32_t specified_platform,
       }
     }
   }
+
+  if (use_sysman) {
+    sysman = std::make_shared<SysmanMonitor>();
+    /* Sysman is enumerated on the root device; a sub-device only reads the
+     * domains that belong to it */
+    if (device_property.flags & ZE_DEVICE_PROPERTY_FLAG_SUBDEVICE)
+      sysman->init(get_root_device(device), true,
+                   device_property.subdeviceId);
+    else
+      sysman->init(device);
+    if (!sysman->available()) {
+      std::cout << "Sysman not available on this device, power and "
+                   "frequency will not be reported\n";
+      sysman.reset();
+    }
+  }
 }
 
 //---------------------------------------------------------------------
@@ -301,6 +488,8 @@ void L0Context::init_xe(uint32_t specified_platform,
 void L0Context::clean_xe() {
   ze_result_t result = ZE_RESULT_SUCCESS;
 
+  sysman.reset();
+
   result = zeCommandQueueDestroy(command_queue);
   if (result) {
     throw std::runtime_error("zeCommandQueueDestroy failed: " +
@@ -338,6 +527,9 @@ void L0Context::clean_xe() {
       std::cout << "Copy command_list destroyed\n";
   }
 
+  if (!owns_context)
+    return;
+
   result = zeContextDestroy(context);
   if (result) {
     throw std::runtime_error("zeContextDestroy failed: " +
@@ -537,22 +729,36 @@ void single_event_create(ze_event_pool_handle_t event_pool,
 // This function takes a pre-calculated workgroup distribution
 // and will time the kernel executed given the timing type.
 // The current timing types supported are:
-//          BANDWIDTH -> Average time to execute the kernel for # iterations
-//          BANDWIDTH_EVENT_TIMING -> Average time to execute the kernel for #
-//                                    iterations using Level Zero Events
-//          KERNEL_LAUNCH_LATENCY->Average time to execute the kernel on
+//          BANDWIDTH -> Time per iteration of # iterations submitted
+//                       back to back and synchronized once
+//          BANDWIDTH_EVENT_TIMING -> Time to execute the kernel measured
+//                                    with Level Zero Events
+//          KERNEL_LAUNCH_LATENCY->Time to execute the kernel on
 //                                  the command list
-//          KERNEL_COMPLETE_LATENCY - Average time to execute a given kernel
-//                                  for # iterations.
-// On success, the average time in microseconds is returned.
+//          KERNEL_COMPLETE_LATENCY - Time to execute a given kernel
+// With event timing, the host-observed time of every submission is also
+// recorded and returned in the timestamps of the statistics.
+// With Sysman, the power, frequency and temperature of the device during
+// the run are returned in the statistics too.
+// One sample is collected per iteration. At least # iterations are run;
+// in auto-iteration mode sampling continues until the confidence
+// interval of the mean is tight enough or max_iters is reached.
+// For BANDWIDTH, the samples are the kernel timestamps of a second pass
+// and only describe the distribution; the mean returned is still the
+// pipelined time.
+// On success, the statistics of the samples in microseconds are returned.
 // On error, an exception will be thrown describing the failure.
 //---------------------------------------------------------------------
-long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
-                               struct ZeWorkGroups &workgroup_info,
-                               TimingMeasurement type,
-                               bool reset_command_list) {
+SampleStatistics ZePeak::run_kernel(L0Context context,
+                                    ze_kernel_handle_t &function,
+                                    struct ZeWorkGroups &workgroup_info,
+                                    TimingMeasurement type,
+                                    bool reset_command_list) {
   ze_result_t result = ZE_RESULT_SUCCESS;
-  long double timed = 0;
+  SampleCollector samples;
+  samples.reserve(iters);
+  TimestampSamples timestamps;
+  long double pipelined_mean = 0;
 
   result = zeKernelSetGroupSize(function, workgroup_info.group_size_x,
                                 workgroup_info.group_size_y,
@@ -566,6 +772,9 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
 
   Timer timer;
 
+  if (context.sysman)
+    context.sysman->start();
+
   if (type == TimingMeasurement::BANDWIDTH) {
     result = zeCommandListAppendLaunchKernel(
         context.command_list, function, &workgroup_info.thread_group_dimensions,
@@ -596,7 +805,54 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
       run_command_queue(context);
     }
     synchronize_command_queue(context);
-    timed = timer.stopAndTime();
+    pipelined_mean = timer.stopAndTime() / iters;
+
+    /* Back-to-back submissions cannot be timed one by one, so the
+     * per-iteration samples come from kernel timestamps of a second pass */
+    context.reset_commandlist(context.command_list);
+
+    ze_event_pool_handle_t event_pool;
+    ze_event_handle_t function_event;
+
+    single_event_pool_create(context, &event_pool,
+                             ZE_EVENT_POOL_FLAG_HOST_VISIBLE |
+                                 ZE_EVENT_POOL_FLAG_KERNEL_TIMESTAMP);
+    single_event_create(event_pool, &function_event);
+
+    result = zeCommandListAppendLaunchKernel(
+        context.command_list, function, &workgroup_info.thread_group_dimensions,
+        function_event, 0, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandListAppendLaunchKernel failed: " +
+                               std::to_string(result));
+    }
+
+    result = zeCommandListClose(context.command_list);
+    if (result) {
+      throw std::runtime_error("zeCommandListClose failed: " +
+                               std::to_string(result));
+    }
+
+    while (!sampling_complete(samples)) {
+      run_command_queue(context);
+
+      result = zeEventHostSynchronize(function_event, UINT64_MAX);
+      if (result) {
+        throw std::runtime_error("zeEventHostSynchronize failed: " +
+                                 std::to_string(result));
+      }
+      samples.add(context_time_in_us(context, function_event));
+
+      synchronize_command_queue(context);
+
+      result = zeEventHostReset(function_event);
+      if (result) {
+        throw std::runtime_error("zeEventHostReset failed: " +
+                                 std::to_string(result));
+      }
+    }
+    zeEventDestroy(function_event);
+    zeEventPoolDestroy(event_pool);
   } else if (type == TimingMeasurement::BANDWIDTH_EVENT_TIMING) {
     ze_event_pool_handle_t event_pool;
     ze_event_handle_t function_event;
@@ -658,7 +914,10 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
         std::cout << "Event Reset" << std::endl;
     }
 
-    for (uint32_t i = 0; i < iters; i++) {
+    while (!sampling_complete(samples)) {
+      uint64_t submit_timestamp = 0;
+      bool correlated = read_device_timestamp(context, submit_timestamp);
+      timer.start();
       result = zeCommandQueueExecuteCommandLists(
           context.command_queue, 1, &context.command_list, nullptr);
       if (result) {
@@ -671,8 +930,11 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
         throw std::runtime_error("zeEventHostSynchronize failed: " +
                                  std::to_string(result));
       }
+      long double host_time = timer.stopAndTime();
 
-      timed += context_time_in_us(context, function_event);
+      samples.add(context_time_in_us(context, function_event));
+      add_timestamp_sample(context, timestamps, function_event, function_event,
+                           submit_timestamp, correlated, host_time);
 
       result = zeCommandQueueSynchronize(context.command_queue, UINT64_MAX);
       if (result) {
@@ -748,7 +1010,7 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
         std::cout << "Event Reset\n";
     }
 
-    for (uint32_t i = 0; i < iters; i++) {
+    while (!sampling_complete(samples)) {
       timer.start();
       result = zeCommandQueueExecuteCommandLists(
           context.command_queue, 1, &context.command_list, nullptr);
@@ -762,7 +1024,7 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
         throw std::runtime_error("zeEventHostSynchronize failed: " +
                                  std::to_string(result));
       }
-      timed += timer.stopAndTime();
+      samples.add(timer.stopAndTime());
 
       result = zeCommandQueueSynchronize(context.command_queue, UINT64_MAX);
       if (result) {
@@ -832,7 +1094,10 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
 
     synchronize_command_queue(context);
 
-    for (uint32_t i = 0; i < iters; i++) {
+    while (!sampling_complete(samples)) {
+      uint64_t submit_timestamp = 0;
+      bool correlated = read_device_timestamp(context, submit_timestamp);
+      timer.start();
       run_command_queue(context);
       synchronize_command_queue(context);
 
@@ -841,8 +1106,12 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
         throw std::runtime_error("zeEventHostSynchronize failed: " +
                                  std::to_string(result));
       }
+      long double host_time = timer.stopAndTime();
 
-      timed += context_time_in_us(context, kernel_duration_event);
+      samples.add(context_time_in_us(context, kernel_duration_event));
+      add_timestamp_sample(context, timestamps, kernel_duration_event,
+                           kernel_duration_event, submit_timestamp, correlated,
+                           host_time);
 
       result = zeEventHostReset(kernel_duration_event);
       if (result) {
@@ -857,7 +1126,159 @@ long double ZePeak::run_kernel(L0Context context, ze_kernel_handle_t &function,
   if (reset_command_list)
     context.reset_commandlist(context.command_list);
 
-  return (timed / static_cast<long double>(iters));
+  if (verbose && (confidence_target > 0))
+    std::cout << "Collected " << samples.size() << " samples, relative CI "
+              << samples.relative_ci95() << "\n";
+
+  SampleStatistics stats = samples.statistics();
+  if (type == TimingMeasurement::BANDWIDTH)
+    stats.mean = pipelined_mean;
+  stats.timestamps = timestamps.breakdown();
+  if (context.sysman)
+    stats.sysman = context.sysman->stop();
+  return stats;
+}
+
+//---------------------------------------------------------------------
+// Utility function to execute a kernel in batched mode: batch_size
+// back-to-back launches of function, optionally separated by barriers,
+// are recorded into one command list which is submitted and synchronized
+// once per iteration. This removes the per-launch submission overhead
+// from the measurement.
+// One sample is collected per submission and divided by batch_size.
+// On success, the statistics of the per-kernel time in microseconds are
+// returned.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+SampleStatistics ZePeak::run_kernel_batched(
+    L0Context context, ze_kernel_handle_t &function,
+    struct ZeWorkGroups &workgroup_info) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  SampleCollector samples;
+  samples.reserve(iters);
+
+  result = zeKernelSetGroupSize(function, workgroup_info.group_size_x,
+                                workgroup_info.group_size_y,
+                                workgroup_info.group_size_z);
+  if (result) {
+    throw std::runtime_error("zeKernelSetGroupSize failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Group size set\n";
+
+  for (uint32_t i = 0; i < batch_size; i++) {
+    if (batch_barriers && (i > 0)) {
+      result =
+          zeCommandListAppendBarrier(context.command_list, nullptr, 0, nullptr);
+      if (result) {
+        throw std::runtime_error("zeCommandListAppendBarrier failed: " +
+                                 std::to_string(result));
+      }
+    }
+
+    result = zeCommandListAppendLaunchKernel(
+        context.command_list, function, &workgroup_info.thread_group_dimensions,
+        nullptr, 0, nullptr);
+    if (result) {
+      throw std::runtime_error("zeCommandListAppendLaunchKernel failed: " +
+                               std::to_string(result));
+    }
+  }
+  if (verbose)
+    std::cout << batch_size << " function launches appended\n";
+
+  result = zeCommandListClose(context.command_list);
+  if (result) {
+    throw std::runtime_error("zeCommandListClose failed: " +
+                             std::to_string(result));
+  }
+  if (verbose)
+    std::cout << "Command list closed\n";
+
+  Timer timer;
+
+  for (uint32_t i = 0; i < warmup_iterations; i++) {
+    run_command_queue(context);
+  }
+
+  synchronize_command_queue(context);
+
+  while (!sampling_complete(samples)) {
+    timer.start();
+    run_command_queue(context);
+    synchronize_command_queue(context);
+    samples.add(timer.stopAndTime() / batch_size);
+  }
+
+  context.reset_commandlist(context.command_list);
+
+  return samples.statistics();
+}
+
+//---------------------------------------------------------------------
+// Utility function to decide whether enough timing samples have been
+// collected. The configured number of iterations is always run. In
+// auto-iteration mode sampling continues until the half-width of the
+// 95% confidence interval is within confidence_target of the mean, or
+// until max_iters samples have been taken.
+//---------------------------------------------------------------------
+bool ZePeak::sampling_complete(const SampleCollector &samples) {
+  if (samples.size() < iters)
+    return false;
+  if (confidence_target <= 0 || samples.size() >= max_iters)
+    return true;
+  return samples.relative_ci95() <= confidence_target;
+}
+
+//---------------------------------------------------------------------
+// Utility function to print the distribution of the timing samples
+// that a result was calculated from.
+//---------------------------------------------------------------------
+void ZePeak::print_timing_statistics(const SampleStatistics &stats) {
+  std::cout << "    [uS] min " << stats.min << " median " << stats.median
+            << " p90 " << stats.p90 << " p99 " << stats.p99 << " max "
+            << stats.max << " stddev " << stats.stddev << " cv "
+            << stats.cv * 100 << "% n " << stats.count << "\n";
+}
+
+//---------------------------------------------------------------------
+// Utility function to print the host-observed time of a submission next
+// to the device execution time and the gap between the two.
+//---------------------------------------------------------------------
+void ZePeak::print_timestamp_breakdown(const TimestampBreakdown &timestamps) {
+  std::cout << "    [uS] host " << timestamps.host << " device "
+            << timestamps.device << " gap "
+            << timestamps.host - timestamps.device;
+  if (timestamps.correlated)
+    std::cout << " (launch " << timestamps.launch << " completion "
+              << timestamps.completion << ")";
+  std::cout << "\n";
+}
+
+//---------------------------------------------------------------------
+// Utility function to print the power, frequency and temperature seen
+// during a test, and the result normalized by power and by frequency.
+//---------------------------------------------------------------------
+void ZePeak::print_sysman_reading(const SysmanReading &reading,
+                                  long double value,
+                                  const std::string &units) {
+  std::cout << "    [sysman]";
+  if (reading.has_power)
+    std::cout << " " << reading.power << " W";
+  if (reading.has_frequency)
+    std::cout << " " << reading.frequency << " MHz (min "
+              << reading.min_frequency << ")";
+  if (reading.has_temperature)
+    std::cout << " " << reading.temperature << " C";
+  if (reading.has_power && (reading.power > 0))
+    std::cout << " " << value / reading.power << " " << units << "/W";
+  if (reading.has_frequency && (reading.frequency > 0))
+    std::cout << " " << value / reading.frequency << " " << units << "/MHz";
+  if (reading.throttled)
+    std::cout << " THROTTLED (reasons 0x" << std::hex
+              << reading.throttle_reasons << std::dec << ")";
+  std::cout << "\n";
 }
 
 //---------------------------------------------------------------------
@@ -917,6 +1338,74 @@ uint64_t ZePeak::get_max_work_items(L0Context &context) {
          context.device_compute_property.maxGroupSizeX;
 }
 
+//---------------------------------------------------------------------
+// Utility function to measure function in batched mode and to report
+// its result next to the per-submit result it was measured against.
+// The gap between the two is the share of the per-submit result lost to
+// submission and synchronization overhead. Both sides of the gap are
+// host times.
+//---------------------------------------------------------------------
+void ZePeak::report_batched_result(
+    L0Context &context, ze_kernel_handle_t &function,
+    struct ZeWorkGroups &workgroup_info, const std::string &test,
+    const std::string &variant, uint32_t vector_width,
+    long double work_per_launch, const std::string &units,
+    const SampleStatistics &per_submit) {
+  std::string batched_variant = variant + " (batch " +
+                                std::to_string(batch_size) +
+                                (batch_barriers ? ", barriers)" : ")");
+
+  std::cout << batched_variant << " : ";
+  SampleStatistics timed =
+      run_kernel_batched(context, function, workgroup_info);
+  long double value = calculate_gbps(timed.mean, work_per_launch);
+  report_result(context, test, batched_variant, vector_width, value, units,
+                timed);
+
+  /* The batched result is timed on the host, so with event timing it is
+   * compared with the host time of the per-submit run */
+  long double per_submit_time = per_submit.timestamps.valid
+                                    ? per_submit.timestamps.host
+                                    : per_submit.mean;
+  long double per_submit_value =
+      calculate_gbps(per_submit_time, work_per_launch);
+  if (per_submit_value > 0) {
+    std::cout << "    gap vs per-submit: "
+              << (value - per_submit_value) / per_submit_value * 100
+              << "%\n";
+  }
+}
+
+//---------------------------------------------------------------------
+// Utility function to print a result followed by the distribution of the
+// samples it was calculated from, and to record it for the JSON/CSV output.
+// Results that are not calculated from per-iteration samples are reported
+// with empty statistics.
+//---------------------------------------------------------------------
+void ZePeak::report_result(L0Context &context, const std::string &test,
+                           const std::string &variant, uint32_t vector_width,
+                           long double value, const std::string &units,
+                           const SampleStatistics &stats) {
+  std::cout << value << " " << units << "\n";
+  if (stats.count)
+    print_timing_statistics(stats);
+  if (stats.timestamps.valid)
+    print_timestamp_breakdown(stats.timestamps);
+  if (stats.sysman.valid)
+    print_sysman_reading(stats.sysman, value, units);
+
+  ZePeakResult result;
+  result.test = test;
+  result.variant = variant;
+  result.vector_width = vector_width;
+  result.units = units;
+  result.value = value;
+  result.stats = stats;
+  result.device_name = context.device_property.name;
+  result.device_uuid = device_uuid_to_string(context.device_property.uuid);
+  results.add(result);
+}
+
 //---------------------------------------------------------------------
 // Utility function to print a standard string to end a test.
 //---------------------------------------------------------------------
@@ -924,6 +1413,38 @@ void ZePeak::print_test_complete() {
   std::cout << "<<<<<<<<<<<<<<<<<<<<<<<<<<<<\n";
 }
 
+//---------------------------------------------------------------------
+// Utility function to run each test requested on the device of context.
+//---------------------------------------------------------------------
+void ZePeak::run_selected_tests(L0Context &context) {
+  if (run_global_bw)
+    ze_peak_global_bw(context);
+
+  if (run_hp_compute)
+    ze_peak_hp_compute(context);
+
+  if (run_sp_compute)
+    ze_peak_sp_compute(context);
+
+  if (run_dp_compute)
+    ze_peak_dp_compute(context);
+
+  if (run_int_compute)
+    ze_peak_int_compute(context);
+
+  if (run_transfer_bw)
+    ze_peak_transfer_bw(context);
+
+  if (run_kernel_lat)
+    ze_peak_kernel_latency(context);
+
+  if (run_working_set)
+    ze_peak_working_set(context);
+
+  if (run_overlap)
+    ze_peak_overlap(context);
+}
+
 //---------------------------------------------------------------------
 // Main function which calls the argument parsing and calls each
 // test requested.
@@ -934,32 +1455,29 @@ int main(int argc, char **argv) {
 
   peak_benchmark.parse_arguments(argc, argv);
   context.verbose = peak_benchmark.verbose;
+  context.module_cache_dir = peak_benchmark.module_cache_dir;
+  if (peak_benchmark.use_sysman) {
+    enable_sysman();
+    context.use_sysman = true;
+  }
 
   context.init_xe(peak_benchmark.specified_platform,
                   peak_benchmark.specified_device);
 
-  if (peak_benchmark.run_global_bw)
-    peak_benchmark.ze_peak_global_bw(context);
-
-  if (peak_benchmark.run_hp_compute)
-    peak_benchmark.ze_peak_hp_compute(context);
-
-  if (peak_benchmark.run_sp_compute)
-    peak_benchmark.ze_peak_sp_compute(context);
-
-  if (peak_benchmark.run_dp_compute)
-    peak_benchmark.ze_peak_dp_compute(context);
+  if (peak_benchmark.run_concurrent) {
+    peak_benchmark.ze_peak_concurrent(context);
+  } else if (peak_benchmark.run_all_devices) {
+    peak_benchmark.ze_peak_all_devices(context);
+  } else {
+    peak_benchmark.results.add_device(context.device_property);
+    peak_benchmark.run_selected_tests(context);
+  }
 
-  if (peak_benchmark.run_int_compute)
-    peak_benchmark.ze_peak_int_compute(context);
+  context.clean_xe();
 
-  if (peak_benchmark.run_transfer_bw)
-    peak_benchmark.ze_peak_transfer_bw(context);
+  peak_benchmark.print_module_loads(context.module_loads);
 
-  if (peak_benchmark.run_kernel_lat)
-    peak_benchmark.ze_peak_kernel_latency(context);
-
-  context.clean_xe();
+  peak_benchmark.results.write();
 
   std::cout << std::flush;
 
@@ -1035,3 +1553,104 @@ long double ZePeak::context_time_in_us(L0Context &context,
 
   return (context_time_ns / 1000); // time is returned in microseconds
 }
+
+//---------------------------------------------------------------------
+// Utility function to convert the distance between two device timestamps
+// to microseconds, accounting for the timestamp counter wrapping around.
+//---------------------------------------------------------------------
+long double ZePeak::timestamp_ticks_to_us(L0Context &context, uint64_t start,
+                                          uint64_t end) {
+  const uint32_t valid_bits = context.device_property.kernelTimestampValidBits;
+  const uint64_t timestamp_max_value =
+      (valid_bits >= 64) ? UINT64_MAX : ((uint64_t(1) << valid_bits) - 1);
+  uint64_t ticks = (end >= start) ? (end - start)
+                                  : ((timestamp_max_value - start) + end + 1);
+
+  return ticks * (long double)context.device_property.timerResolution / 1000;
+}
+
+//---------------------------------------------------------------------
+// Utility function to read the device global timestamp counter, the one
+// kernel timestamps are taken from, at the current host time.
+// Returns false if the driver cannot correlate the device and host
+// clocks.
+//---------------------------------------------------------------------
+bool ZePeak::read_device_timestamp(L0Context &context, uint64_t &timestamp) {
+  uint64_t host_timestamp = 0;
+  uint64_t device_timestamp = 0;
+
+  ze_result_t result = zeDeviceGetGlobalTimestamps(
+      context.device, &host_timestamp, &device_timestamp);
+  if (result)
+    return false;
+
+  const uint32_t valid_bits = context.device_property.kernelTimestampValidBits;
+  if (valid_bits < 64)
+    device_timestamp &= (uint64_t(1) << valid_bits) - 1;
+  timestamp = device_timestamp;
+  return true;
+}
+
+//---------------------------------------------------------------------
+// Utility function to add the timestamps of one submission to samples.
+// The device time runs from the start of the command that signaled
+// first_event to the end of the one that signaled last_event, and
+// host_time from the submission to the host seeing completion. With
+// submit_timestamp, the device timestamp read just before submitting,
+// the gap between the two is split into launch and completion time.
+// On error, an exception will be thrown describing the failure.
+//---------------------------------------------------------------------
+void ZePeak::add_timestamp_sample(L0Context &context,
+                                  TimestampSamples &samples,
+                                  ze_event_handle_t first_event,
+                                  ze_event_handle_t last_event,
+                                  uint64_t submit_timestamp, bool correlated,
+                                  long double host_time) {
+  ze_result_t result = ZE_RESULT_SUCCESS;
+  ze_kernel_timestamp_result_t first = {};
+  ze_kernel_timestamp_result_t last = {};
+
+  result = zeEventQueryKernelTimestamp(first_event, &first);
+  if (result) {
+    throw std::runtime_error("zeEventQueryKernelTimeStamp failed: " +
+                             std::to_string(result));
+  }
+  result = zeEventQueryKernelTimestamp(last_event, &last);
+  if (result) {
+    throw std::runtime_error("zeEventQueryKernelTimeStamp failed: " +
+                             std::to_string(result));
+  }
+
+  long double device_time = timestamp_ticks_to_us(
+      context, first.global.kernelStart, last.global.kernelEnd);
+  samples.host.add(host_time);
+  samples.device.add(device_time);
+
+  samples.correlated = samples.correlated && correlated;
+  if (samples.correlated) {
+    long double launch_time = timestamp_ticks_to_us(
+        context, submit_timestamp, first.global.kernelStart);
+    samples.launch.add(launch_time);
+    samples.completion.add(host_time - launch_time - device_time);
+  }
+}
+
+//---------------------------------------------------------------------
+// Returns the means of the samples, with the launch and completion split
+// only if every sample could be correlated with the host clock.
+//---------------------------------------------------------------------
+TimestampBreakdown TimestampSamples::breakdown() const {
+  TimestampBreakdown breakdown;
+  if (!host.size())
+    return breakdown;
+
+  breakdown.valid = true;
+  breakdown.host = host.statistics().mean;
+  breakdown.device = device.statistics().mean;
+  breakdown.correlated = correlated && launch.size();
+  if (breakdown.correlated) {
+    breakdown.launch = launch.statistics().mean;
+    breakdown.completion = completion.statistics().mean;
+  }
+  return breakdown;
+}